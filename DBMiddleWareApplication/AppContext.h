@@ -4,12 +4,15 @@
 #include <spdlog/spdlog.h>
 
 class MySqlPool;
+class DbExecutor;
+class QueryCache;
 
 class AppContext {
 public:
     std::shared_ptr<spdlog::logger> logger;
-    nlohmann::json config;
     std::shared_ptr<MySqlPool> db;
+    std::shared_ptr<DbExecutor> db_executor;   // DB 전용 워커 풀 (네트워크 스레드 블로킹 방지)
+    std::shared_ptr<QueryCache> query_cache;   // select 결과 캐시 (비활성 시 nullptr)
 
     static AppContext& instance() {
         static AppContext ctx;
@@ -0,0 +1,119 @@
+﻿#include "Config.h"
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <vector>
+#include "AppContext.h"
+
+namespace {
+    const Config kDefaultConfig{};
+
+    std::mutex g_publish_mutex;                                 // 발행끼리만 직렬화 (읽기는 락 없음)
+    uint64_t g_version = 0;
+}
+
+namespace config_detail {
+    std::atomic<const Config*> g_current{ &kDefaultConfig };
+}
+
+Config Config::from_json(const nlohmann::json& j) {
+    Config c;
+    c.login_timeout = std::chrono::seconds(j.value("login_timeout_seconds", static_cast<int64_t>(c.login_timeout.count())));
+    c.max_unauth_sessions = j.value("max_unauth_sessions", c.max_unauth_sessions);
+    c.max_write_queue_size = j.value("max_write_queue_size", c.max_write_queue_size);
+    c.write_queue_warn_threshold = j.value("write_queue_warn_threshold", c.write_queue_warn_threshold);
+    c.write_queue_overflow_limit = j.value("write_queue_overflow_limit", c.write_queue_overflow_limit);
+    c.write_batch_max_msgs = std::max<size_t>(1, j.value("write_batch_max_msgs", c.write_batch_max_msgs));
+    c.write_batch_max_bytes = j.value("write_batch_max_bytes", c.write_batch_max_bytes);
+    c.recv_buffer_min = j.value("recv_buffer_min", c.recv_buffer_min);
+    c.recv_buffer_max = std::max(c.recv_buffer_min, j.value("recv_buffer_max", c.recv_buffer_max));
+    c.recv_buffer_initial = std::clamp(j.value("recv_buffer_initial", c.recv_buffer_initial), c.recv_buffer_min, c.recv_buffer_max);
+    c.max_packet_size = std::max<uint32_t>(16, j.value("max_packet_size", c.max_packet_size));
+    c.max_outbound_packet_size = std::max<uint32_t>(1024, j.value("max_outbound_packet_size", c.max_outbound_packet_size));
+    c.legacy_secret_per_packet = j.value("legacy_secret_per_packet", c.legacy_secret_per_packet);
+    c.idle_timeout = std::chrono::seconds(j.value("session_idle_timeout_seconds", static_cast<int64_t>(c.idle_timeout.count())));
+    c.close_max_retries = j.value("session_max_close_retries", c.close_max_retries);
+    c.close_retry_delay = std::chrono::milliseconds(j.value("session_retry_delay_ms", static_cast<int64_t>(c.close_retry_delay.count())));
+
+    c.metrics_port = j.value("metrics_port", c.metrics_port);
+    c.metrics_bind_address = j.value("metrics_bind_address", c.metrics_bind_address);
+    c.metrics_request_timeout = std::chrono::milliseconds(std::max<int64_t>(100, j.value("metrics_request_timeout_ms", static_cast<int64_t>(c.metrics_request_timeout.count()))));
+    c.admin_reload_enabled = j.value("admin_reload_enabled", c.admin_reload_enabled);
+
+    c.trace_enabled = j.value("trace_enabled", c.trace_enabled);
+    c.trace_slow_threshold = std::chrono::milliseconds(j.value("trace_slow_threshold_ms", static_cast<int64_t>(c.trace_slow_threshold.count())));
+    c.trace_slow_ring_size = std::max<size_t>(1, j.value("trace_slow_ring_size", c.trace_slow_ring_size));
+
+    c.timer_wheel_tick = std::chrono::milliseconds(std::max<int64_t>(1, j.value("timer_wheel_tick_ms", static_cast<int64_t>(c.timer_wheel_tick.count()))));
+
+    c.select_max_rows = std::max<size_t>(1, j.value("select_max_rows", c.select_max_rows));
+    c.query_cache_enabled = j.value("query_cache_enabled", c.query_cache_enabled);
+    c.query_cache_max_bytes = j.value("query_cache_max_mb", c.query_cache_max_bytes / (1024 * 1024)) * 1024 * 1024;
+    c.query_cache_shards = std::max<size_t>(1, j.value("query_cache_shards", c.query_cache_shards));
+    c.query_cache_ttl = std::chrono::milliseconds(j.value("query_cache_ttl_ms", static_cast<int64_t>(c.query_cache_ttl.count())));
+
+    c.stream_chunk_rows = std::max<size_t>(1, j.value("stream_chunk_rows", c.stream_chunk_rows));
+    c.stream_chunk_bytes = std::clamp<size_t>(j.value("stream_chunk_bytes", c.stream_chunk_bytes), 256, c.max_outbound_packet_size);
+    c.stream_high_water = std::max<size_t>(1, j.value("stream_high_water", c.stream_high_water));
+    c.stream_stall_timeout = std::chrono::milliseconds(j.value("stream_stall_timeout_ms", static_cast<int64_t>(c.stream_stall_timeout.count())));
+    c.stream_max_concurrent = j.value("stream_max_concurrent", c.stream_max_concurrent);
+
+    c.io_mode = j.value("io_mode", c.io_mode);
+    c.io_threads = j.value("io_threads", c.io_threads);
+    c.io_pin_threads = j.value("io_pin_threads", c.io_pin_threads);
+
+    c.log_async = j.value("log_async", c.log_async);
+    c.log_queue_size = std::max<size_t>(1, j.value("log_queue_size", c.log_queue_size));
+    c.log_flush_level = j.value("log_flush_level", c.log_flush_level);
+    c.log_flush_interval = std::chrono::seconds(std::max<int64_t>(1, j.value("log_flush_interval_sec", static_cast<int64_t>(c.log_flush_interval.count()))));
+    c.log_categories = j.value("log_categories", c.log_categories);
+
+    c.insert_batch_enabled = j.value("insert_batch_enabled", c.insert_batch_enabled);
+    c.insert_batch_max_rows = j.value("insert_batch_max_rows", c.insert_batch_max_rows);
+    c.insert_batch_window = std::chrono::milliseconds(j.value("insert_batch_window_ms", static_cast<int64_t>(c.insert_batch_window.count())));
+
+    c.db_worker_threads = j.value("db_worker_threads", c.db_worker_threads);
+    c.db_max_queue = j.value("db_max_queue", c.db_max_queue);
+    c.db_stmt_cache_size = j.value("db_stmt_cache_size", c.db_stmt_cache_size);
+    c.db_max_connections = j.value("db_max_connections", c.db_max_connections);
+    c.db_acquire_timeout = std::chrono::milliseconds(j.value("db_acquire_timeout_ms", static_cast<int64_t>(c.db_acquire_timeout.count())));
+    c.db_warmup_threads = j.value("db_warmup_threads", c.db_warmup_threads);
+    c.db_min_ready_connections = j.value("db_min_ready_connections", c.db_min_ready_connections);
+    c.db_warmup_timeout = std::chrono::milliseconds(j.value("db_warmup_timeout_ms", static_cast<int64_t>(c.db_warmup_timeout.count())));
+    c.db_health_check_interval = std::chrono::milliseconds(j.value("db_health_check_interval_ms", static_cast<int64_t>(c.db_health_check_interval.count())));
+    c.db_health_idle_threshold = std::chrono::milliseconds(j.value("db_health_idle_threshold_ms", static_cast<int64_t>(c.db_health_idle_threshold.count())));
+    c.db_conn_max_lifetime = std::chrono::seconds(j.value("db_conn_max_lifetime_sec", static_cast<int64_t>(c.db_conn_max_lifetime.count())));
+
+    c.raw = j;
+    return c;
+}
+
+void publish_config(Config config) {
+    const Config* old = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_publish_mutex);
+        config.version = ++g_version;
+        old = config_detail::g_current.exchange(new Config(std::move(config)));   // seq_cst (Epoch.h)
+    }
+    // 교체 시점에 읽고 있던 ConfigRef 가 모두 끝나면 해제 (기본값 스냅샷은 static 이라 제외)
+    if (old != &kDefaultConfig) {
+        epoch::retire(old);
+    }
+}
+
+bool reload_config(const std::string& path) {
+    try {
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            AppContext::instance().logger->error("[Config] reload 실패: 파일 오픈 불가 {}", path);
+            return false;
+        }
+        publish_config(Config::from_json(nlohmann::json::parse(in)));
+        AppContext::instance().logger->info("[Config] reload 완료: {} (version={})", path, current_config()->version);
+        return true;
+    }
+    catch (const std::exception& e) {
+        AppContext::instance().logger->error("[Config] reload 실패, 기존 설정 유지: {}", e.what());
+        return false;
+    }
+}
@@ -0,0 +1,135 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "Epoch.h"
+
+// config.json 을 한 번 읽어 만든 타입 있는 불변 스냅샷
+// - 읽기: current_config() → ConfigRef (epoch 진입 + atomic 포인터 load 1번, 락/문자열 lookup 없음)
+// - 갱신: reload_config() (SIGHUP 또는 관리 HTTP POST /admin/reload_config) 가 새 스냅샷을 만들어 포인터만 교체 (RCU 방식)
+//   교체된 스냅샷은 epoch::retire → 그때 읽고 있던 ConfigRef 가 모두 끝난 뒤 해제
+//   → ConfigRef 는 함수 안 지역 변수로만 (복사/이동 불가라 멤버/람다에 보관 불가, 필요한 값은 복사)
+// - 세션/네트워크 값은 reload 즉시 반영: 세션별 한도(recv_buffer_*, max_packet_size, write_batch_*)는
+//   기존 세션도 다음 read 때 새 값으로 갱신. DB/배칭 등 "(시작 시)" 표시된 값은 시작 시 한 번만 사용
+struct Config {
+    // --- 세션 / 네트워크 ---
+    std::chrono::seconds login_timeout{ 90 };
+    size_t max_unauth_sessions = 0;                           // secret 을 아직 안 보낸(Handshaking) 세션 상한, 모니터 주기마다 오래된 것부터 종료 (0 = 끔)
+    size_t max_write_queue_size = 100;
+    size_t write_queue_warn_threshold = 80;
+    size_t write_queue_overflow_limit = 10;
+    size_t write_batch_max_msgs = 64;
+    size_t write_batch_max_bytes = 65536;
+    size_t recv_buffer_initial = 4096;
+    size_t recv_buffer_min = 1024;
+    size_t recv_buffer_max = 65536;
+    uint32_t max_packet_size = 4096;                          // 수신 프레임 최대 길이 (초과 시 세션 종료, 요청은 작으므로 작게 유지)
+    uint32_t max_outbound_packet_size = 65536;                // 송신 프레임 최대 길이 (클라이언트 수신 한도, 조회 응답이 이 안에 맞춰짐)
+    bool legacy_secret_per_packet = false;
+    std::chrono::seconds idle_timeout{ 0 };                   // 마지막 수신 후 이 시간 지나면 종료 (0 = 끔, 기본 끔: 켜면 그 뒤 접속한 세션부터)
+    size_t close_max_retries = 3;                             // socket close 실패 시 재시도 횟수
+    std::chrono::milliseconds close_retry_delay{ 100 };
+
+    // --- 모니터링 (시작 시) ---
+    unsigned short metrics_port = 0;                  // /metrics HTTP 포트 (0 = 끔)
+    std::string metrics_bind_address = "127.0.0.1";   // 기본은 로컬만 (외부 수집기가 직접 긁어야 할 때만 "0.0.0.0")
+    std::chrono::milliseconds metrics_request_timeout{ 5000 };   // 요청 헤더 수신 ~ 응답 송신 완료까지 한도 (넘으면 연결 닫음)
+    bool admin_reload_enabled = false;                // POST /admin/reload_config 등록 (인증 없음, bind 와 상관없이 loopback 에서 온 요청만 받음)
+
+    // --- 요청 trace (trace_enabled / 임계치는 reload 즉시, ring 크기는 시작 시) ---
+    bool trace_enabled = true;                                // 요청마다 단계별 시각 기록
+    std::chrono::milliseconds trace_slow_threshold{ 200 };    // 이 이상 걸린 요청은 slow ring buffer 에 (0 = 끔)
+    size_t trace_slow_ring_size = 256;
+
+    // --- 타이머 휠 (시작 시) ---
+    std::chrono::milliseconds timer_wheel_tick{ 100 };        // 세션 타이머 해상도
+
+    // --- 네트워크 스레드 (시작 시) ---
+    std::string io_mode = "shared";                   // "shared" | "per_core"
+    size_t io_threads = 0;                            // 0 = hardware_concurrency
+    bool io_pin_threads = false;                      // per_core 에서 스레드를 CPU 에 고정 (Linux)
+
+    // --- 로그 (시작 시, log_categories 는 reload 시에도 반영) ---
+    bool log_async = true;
+    size_t log_queue_size = 8192;                     // async ring buffer 크기 (메시지 수)
+    std::string log_flush_level = "warn";
+    std::chrono::seconds log_flush_interval{ 1 };
+    nlohmann::json log_categories = nlohmann::json::object();
+
+    // --- insert 배칭 (시작 시) ---
+    bool insert_batch_enabled = true;
+    size_t insert_batch_max_rows = 100;
+    std::chrono::milliseconds insert_batch_window{ 5 };
+
+    // --- select / 결과 캐시 (캐시 크기는 시작 시, 나머지는 reload 즉시) ---
+    size_t select_max_rows = 1000;                            // select 1번에 돌려주는 최대 행 수 (limit 상한)
+    bool query_cache_enabled = true;
+    size_t query_cache_max_bytes = 64 * 1024 * 1024;          // 전체 메모리 한도 (shard 별로 나눔)
+    size_t query_cache_shards = 16;
+    std::chrono::milliseconds query_cache_ttl{ 5000 };        // 기본 TTL (요청의 cache_ttl_ms 는 이보다 짧게만)
+
+    // --- select_stream (reload 즉시) ---
+    size_t stream_chunk_rows = 500;                           // rows_chunk 1개에 담는 최대 행 수
+    size_t stream_chunk_bytes = 32768;                        // rows_chunk 1개의 목표 크기 (어림값으로 자름, max_outbound_packet_size 이하로 보정)
+    size_t stream_high_water = 8;                             // 세션 송신 대기가 이 이상이면 생산 중단 (워커는 놓고 write 완료 때 재개)
+    std::chrono::milliseconds stream_stall_timeout{ 30000 };  // 이 시간 동안 송신이 안 빠지면 스트림 중단 (커넥션 폐기)
+    size_t stream_max_concurrent = 4;                         // 동시에 도는 스트림 수 (각자 DB 커넥션 1개 점유)
+
+    // --- DB (시작 시, 0 = pool_size 기준 자동) ---
+    size_t db_worker_threads = 0;
+    size_t db_max_queue = 10000;
+    size_t db_stmt_cache_size = 64;
+    size_t db_max_connections = 0;
+    std::chrono::milliseconds db_acquire_timeout{ 2000 };
+    size_t db_warmup_threads = 8;
+    size_t db_min_ready_connections = 1;
+    std::chrono::milliseconds db_warmup_timeout{ 10000 };
+    std::chrono::milliseconds db_health_check_interval{ 10000 };
+    std::chrono::milliseconds db_health_idle_threshold{ 30000 };
+    std::chrono::seconds db_conn_max_lifetime{ 3600 };
+
+    nlohmann::json raw = nlohmann::json::object();   // 원본 (위에 없는 키 / 플러그인용)
+    uint64_t version = 0;                            // 발행 순번 (reload 마다 +1)
+
+    // json → Config (없는 키는 위 기본값)
+    static Config from_json(const nlohmann::json& j);
+};
+
+namespace config_detail {
+    extern std::atomic<const Config*> g_current;
+}
+
+// 현재 스냅샷 읽기 핸들: 살아 있는 동안 스냅샷이 해제되지 않음 (epoch::Guard, 같은 스레드에서 중첩 가능)
+// - 한 줄 읽기는 current_config()->x, 여러 값은 auto config = current_config(); 후 config->x
+// - 임시 객체에 * 는 금지 (const Config& c = *current_config(); 는 바로 해제될 수 있는 참조) → 오래 쓸 값은 copy()
+// - Guard 동안은 회수가 멈추므로 블로킹 작업(DB 대기 등) 동안 들고 있지 말 것
+class ConfigRef {
+public:
+    ConfigRef() : config_(config_detail::g_current.load()) {}   // seq_cst: epoch 진입 기록 뒤에 읽음 (Epoch.h)
+    ConfigRef(const ConfigRef&) = delete;
+    ConfigRef& operator=(const ConfigRef&) = delete;
+
+    const Config* operator->() const { return config_; }
+    const Config& operator*() const& { return *config_; }
+    const Config& operator*() const&& = delete;
+    Config copy() const { return *config_; }
+
+private:
+    epoch::Guard guard_;   // config_ 보다 먼저 선언 (포인터를 읽기 전에 진입)
+    const Config* config_;
+};
+
+// 어느 스레드에서든 (C++17 보장 복사 생략으로 이동 없이 반환)
+inline ConfigRef current_config() {
+    return ConfigRef();
+}
+
+// 새 스냅샷 발행 (version 은 여기서 매김, 이전 스냅샷은 epoch::retire)
+void publish_config(Config config);
+
+// 파일을 다시 읽어 발행. 실패 시 기존 스냅샷 유지하고 false
+bool reload_config(const std::string& path = "config.json");
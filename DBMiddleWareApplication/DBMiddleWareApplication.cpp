@@ -9,6 +9,14 @@
 #include "Utility.h"
 #include "AppContext.h"
 #include "MySqlPool.h"
+#include "DbExecutor.h"
+#include "Config.h"
+#include "IoContextPool.h"
+#include "MetricsServer.h"
+#include "RequestTrace.h"
+#include "QueryCache.h"
+#include <csignal>
+#include <functional>
 
 using namespace std;
 using boost::asio::ip::tcp;
@@ -29,8 +37,14 @@ static std::string getenv_or(const char* k, const char* def) {
 
 int main()
 {
+    // 로거가 config(log_async 등)를 보므로 config 먼저
+    try {
+        load_config();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[Config] " << e.what() << " (기본값으로 시작)\n";
+    }
     init_logger();
-    load_config();
 
     AppContext::instance().logger->info("=== DB MiddleWare 시작! ===");
 
@@ -54,17 +68,50 @@ int main()
 
         unsigned int port = static_cast<unsigned int>(std::stoul(port_str));
 
-        AppContext::instance().config["db"] = {
-            {"host", host}, {"port", port_str}, {"user", user}, {"schema", schema}, {"pool_size", pool_size}
-        };
+        AppContext::instance().logger->info("[DB] host={}, port={}, user={}, schema={}, pool_size={}", host, port_str, user, schema, pool_size);
+
+        const Config config = current_config().copy();   // 시작 시 값 복사 (reload 후 이전 스냅샷은 해제되므로 참조로 들고 있지 않음)
+        MySqlPoolOptions pool_opts;
+        pool_opts.stmt_cache_capacity = config.db_stmt_cache_size;
+        pool_opts.max_connections = static_cast<size_t>(std::stoul(getenv_or("DB_MAX_CONNECTIONS",
+            std::to_string(config.db_max_connections ? config.db_max_connections : pool_size * 2).c_str())));
+        pool_opts.acquire_timeout = config.db_acquire_timeout;
+        pool_opts.warmup_threads = config.db_warmup_threads;
+        pool_opts.health_interval = config.db_health_check_interval;
+        pool_opts.health_idle_threshold = config.db_health_idle_threshold;
+        pool_opts.max_lifetime = config.db_conn_max_lifetime;
+        AppContext::instance().db = std::make_shared<MySqlPool>(host, port, user, pass, schema, pool_size, pool_opts);
+
+        // warm-up 은 병렬로 진행, 최소 개수만 준비되면 리스너 시작 (나머지는 백그라운드에서 계속)
+        size_t min_ready = config.db_min_ready_connections;
+        auto warmup_timeout = config.db_warmup_timeout;
+        if (AppContext::instance().db->wait_ready(min_ready, warmup_timeout)) {
+            AppContext::instance().logger->info("[DB] Pool ready. {}/{} connections", AppContext::instance().db->stats().ready, pool_size);
+        }
+        else {
+            AppContext::instance().logger->warn("[DB] Pool warm-up: only {}/{} connections ready (min={}), starting anyway",
+                AppContext::instance().db->stats().ready, pool_size, min_ready);
+        }
+
+        // DB 워커 풀: 블로킹 MySQL 호출은 여기서만 실행
+        size_t db_workers = config.db_worker_threads ? config.db_worker_threads : pool_size;
+        size_t db_max_queue = config.db_max_queue;
+        AppContext::instance().db_executor = std::make_shared<DbExecutor>(AppContext::instance().db, db_workers, db_max_queue);
 
-        AppContext::instance().db = std::make_shared<MySqlPool>(host, port, user, pass, schema, pool_size);
-        AppContext::instance().logger->info("[DB] Pool ready. {} connections", pool_size);
+        // select 결과 캐시 (insert 가 끝날 때마다 해당 테이블 결과 무효화)
+        if (config.query_cache_enabled) {
+            AppContext::instance().query_cache = std::make_shared<QueryCache>(config.query_cache_shards, config.query_cache_max_bytes);
+        }
 
         // 1. io_context 준비
-        boost::asio::io_context io;
+        //    shared: io_context 1개 × 스레드 N개 / per_core: 코어마다 io_context 1개 × 스레드 1개
+        size_t thread_count = config.io_threads ? config.io_threads : std::thread::hardware_concurrency();
+        if (thread_count == 0) thread_count = 4;
+        bool per_core = config.io_mode == "per_core";
+        IoContextPool io_pool(per_core ? thread_count : 1, per_core ? 1 : thread_count, per_core && config.io_pin_threads);
+        boost::asio::io_context& io = io_pool.get(0);   // 모니터/배칭/시그널 등 공용 작업용
 
-        AppContext::instance().logger->info("[DEBUG] 메인 io_context 주소: {}", (void*)&io);
+        LOG_DEBUG("[DEBUG] 메인 io_context 주소: {}", (void*)&io);
 
         // 2. DataHandler 인스턴스 생성 (io를 전달)
         // DataHandler 객체 생성 및 공유 포인터로 관리
@@ -72,37 +119,55 @@ int main()
         
         auto data_handler = std::make_shared<DataHandler>(io, session_manager, secret);
 
+        // config.json 재적용 (재시작 없이): kill -HUP <pid>
+        // Windows 에는 SIGHUP 이 없으므로 모니터링 포트의 POST /admin/reload_config 사용 (metrics_port, admin_reload_enabled 를 켜야 함)
+#if defined(SIGHUP)
+        boost::asio::signal_set reload_signals(io, SIGHUP);
+        std::function<void(const boost::system::error_code&, int)> on_reload_signal =
+            [&](const boost::system::error_code& ec, int /*signo*/) {
+                if (ec) return;
+                if (reload_config()) {
+                    configure_log_categories(current_config()->log_categories);
+                }
+                reload_signals.async_wait(on_reload_signal);
+            };
+        reload_signals.async_wait(on_reload_signal);
+#endif
+
         // 3. 세션풀, 서버 등 생성
-        Server server(io, DbMiddleWarePort, data_handler);
+        Server server(io_pool, DbMiddleWarePort, data_handler, per_core);
+
+        // 모니터링 HTTP (/metrics, /debug/slow_requests) - 별도 포트, 공용 io_context 에서 처리
+        std::unique_ptr<MetricsServer> metrics_server;
+        if (config.metrics_port != 0) {
+            metrics_server = std::make_unique<MetricsServer>(io, config.metrics_bind_address, config.metrics_port, config.metrics_request_timeout);
+            metrics_server->add_route("/debug/slow_requests", "application/json", []() { return tracing::dump_slow_requests(); });
+            // SIGHUP 과 같은 reload (Windows 용): curl -X POST http://127.0.0.1:<metrics_port>/admin/reload_config
+            // 인증이 없으므로 기본은 꺼 둠, 켜도 loopback 에서 온 요청만 실행 (MetricsServer)
+            if (config.admin_reload_enabled) {
+                metrics_server->add_action("/admin/reload_config", "application/json", []() {
+                    bool ok = reload_config();
+                    if (ok) {
+                        configure_log_categories(current_config()->log_categories);
+                    }
+                    nlohmann::json reply;
+                    reply["result"] = ok ? "ok" : "fail";
+                    reply["version"] = current_config()->version;
+                    return reply.dump();
+                });
+            }
+            metrics_server->start();
+        }
 
         cout << "DB MiddleWare started on port: " << DbMiddleWarePort << endl;
         AppContext::instance().logger->info("DB MiddleWare started on port: {}", DbMiddleWarePort);
 
         // 4. 스레드 풀 및 io.run()
-        size_t thread_count = std::thread::hardware_concurrency();
-        if (thread_count == 0) thread_count = 4;
         cout << "Thread count: " << thread_count << endl;
         //LOG_INFO("Thread count: ", thread_count);
-        AppContext::instance().logger->info("Thread count: {}", thread_count);
-
-        vector<thread> threads;
-        for (size_t i = 0; i < thread_count; ++i) {
-            threads.emplace_back([&io]() {
-                try {
-                    AppContext::instance().logger->info("[DEBUG] io.run() 스레드 진입!");  // ✅ 요기!
-                    io.run();
-                }
-                catch (const std::exception& e) {
-                    //std::cerr << "[FATAL] io_context.run()에서 예외 발생: " << e.what() << std::endl;
-                    //LOG_ERROR("[FATAL] io_context.run()에서 예외 발생: ", e.what());
-                    AppContext::instance().logger->error("[FATAL] io_context.run()에서 예외 발생: {}", e.what());
-                    // 로그 남기고, 필요하다면 복구 시도
-                }
-                });
-        }
+        AppContext::instance().logger->info("Thread count: {}, io mode: {}", thread_count, per_core ? "per_core" : "shared");
 
-        for (auto& t : threads)
-            t.join();
+        io_pool.run();
     }
     catch (const std::exception& e) {
         AppContext::instance().logger->error("DB MiddleWare 시작 중 예외 발생: {}", e.what());
@@ -7,34 +7,37 @@
 #include "Utility.h"
 #include "SessionManager.h"
 #include "MemoryTracker.h"
+#include "Epoch.h"
+#include "Config.h"
 #include <string>
 #include <chrono>
 #include "AppContext.h"
+#include "MysqlPool.h"
 
 using namespace std;
 using namespace boost::asio;
 using boost::asio::ip::udp;
 
+constexpr size_t kNicknameSweepShardsPerTick = 8;   // 모니터 주기(10초)마다 훑을 닉네임 shard 수
+
 DataHandler::DataHandler(boost::asio::io_context& io, std::shared_ptr<SessionManager> session_manager, const std::string& packet)
     : shard_count(max(4u, thread::hardware_concurrency() * 2)),
-    dispatcher_(this, session_manager.get(), packet),
+    dispatcher_(io, this, session_manager.get(), packet),
     monitor_timer_(io),
-    session_manager_(session_manager),
-    cleanup_timer_(io) {
+    session_manager_(session_manager) {
     start_monitor_loop();    // 모니터 루프 시작
-	//start_cleanup_loop();    // session 클린업 타이머 시작
 }
 
 //void DataHandler::dispatch(const std::shared_ptr<Session>& session, const json& msg) {
 //    dispatcher_.dispatch(session, msg);
 //}
 
-void  DataHandler::dispatch(const std::shared_ptr<Session>& session, const std::string& packet) {
+void  DataHandler::dispatch(const std::shared_ptr<Session>& session, std::string_view packet) {
     dispatcher_.dispatch(session, packet);
 }
 
 void DataHandler::add_session(int session_id, std::shared_ptr<Session> session) {
-    AppContext::instance().logger->info("[DEBUG][TCP] DataHandler address: {}", (void*)this);
+    LOG_DEBUG("[DEBUG][TCP] DataHandler address: {}", (void*)this);
     session_manager_->add_session(session);
 }
 
@@ -66,36 +69,14 @@ void DataHandler::for_each_session(const std::function<void(const std::shared_pt
     session_manager_->for_each_session(fn);
 }
 
-// 글로벌 keepalive 체크
-void DataHandler::do_keepalive_check() {
-    auto now = std::chrono::steady_clock::now();
-
-    // 1. close해야 할 세션을 임시로 모아둘 벡터
-    vector<shared_ptr<Session>> sessions_to_close;
-
-    for_each_session([this, now, &sessions_to_close](shared_ptr<Session> sess) {
-        if (!sess) return;
-
-        if (sess->is_nickname_registered() == false) return; // 닉네임 등록 안된 세션은 skip
-
-        });
-
-    // 2. 락 해제 후(즉, 세션 안전하게 순회 후) 실제 close_session 호출
-    for (auto& sess : sessions_to_close) {
-        //cout << "[KEEPALIVE TIMEOUT] session_id=" << sess->get_session_id() << " - close session" << endl;
-        AppContext::instance().logger->info("[KEEPALIVE TIMEOUT] session_id= {}", sess->get_session_id(), "- close session");
-        sess->close_session();
-    }
-}
-
-// 미인증 세션 정리 함수 
-void DataHandler::cleanup_unauth_sessions(size_t max_unauth) {
+// 미인증 세션 정리 함수 (모니터 루프에서 호출)
+// secret 을 통과한 Handshaked 세션은 로그인 타임아웃이 따로 처리하므로 대상이 아님
+size_t DataHandler::cleanup_unauth_sessions(size_t max_unauth) {
     vector<shared_ptr<Session>> unauth_sessions;
 
-    for_each_session([&](const shared_ptr<Session> sess) {
+    for_each_session([&](const shared_ptr<Session>& sess) {
         if (!sess) return;
-        SessionState state = sess->get_state();
-        if (state == SessionState::Handshaking || state == SessionState::LoginWait) {
+        if (sess->get_state() == SessionState::Handshaking) {
             unauth_sessions.push_back(sess);
         }
         });
@@ -112,7 +93,9 @@ void DataHandler::cleanup_unauth_sessions(size_t max_unauth) {
         for (size_t i = 0; i < count_to_close; ++i) {
             unauth_sessions[i]->close_session();
         }
+        return count_to_close;
     }
+    return 0;
 }
 
 // 활성 세션 모니터링 루프 시작
@@ -124,20 +107,80 @@ void DataHandler::start_monitor_loop()
             // 1. 전체 카운트
             AppContext::instance().logger->info("[SERVER] Active sessions: {}", session_manager_->get_total_session_count());
 
-            MemoryTracker::log_memory_usage();   //메모리 사용량도 같이 남김
+            // 만료 닉네임 항목 회수 (한 번에 일부 shard 만 → 모니터 주기 몇 번에 걸쳐 한 바퀴)
+            if (size_t swept = session_manager_->sweep_expired_nicknames(kNicknameSweepShardsPerTick)) {
+                AppContext::instance().logger->info("[NICKNAME SWEEP] expired nickname entries removed: {}", swept);
+            }
 
-            start_monitor_loop(); // 반복
-        }
-        });
-}
+            // 미인증 세션 상한 (0 = 끔)
+            if (size_t max_unauth = current_config()->max_unauth_sessions) {
+                if (size_t closed = cleanup_unauth_sessions(max_unauth)) {
+                    AppContext::instance().logger->warn("[SERVER] unauthenticated sessions over limit {}, closed {}", max_unauth, closed);
+                }
+            }
 
+            // 세션 레지스트리에서 retire 된 스냅샷/항목 회수 (트래픽이 적어 retire 가 안 쌓일 때용)
+            epoch::reclaim();
 
-void DataHandler::start_cleanup_loop() {
-    cleanup_timer_.expires_after(std::chrono::seconds(60)); // 1분마다
-    cleanup_timer_.async_wait([this](const boost::system::error_code& ec) {
-        if (!ec) {
-            session_manager_->cleanup_inactive_sessions(std::chrono::seconds(300)); // 5분 이상 비활성 시 종료
-            start_cleanup_loop(); // 재귀 호출
+            MemoryTracker::log_memory_usage();   //메모리 사용량도 같이 남김
+
+            // 2. 수신 경로: read(syscall) 당 메시지 수, read 당 바이트
+            auto& recv = Session::recv_stats();
+            uint64_t reads = recv.reads.load(std::memory_order_relaxed);
+            uint64_t frames = recv.frames.load(std::memory_order_relaxed);
+            uint64_t bytes = recv.bytes.load(std::memory_order_relaxed);
+            AppContext::instance().logger->info("[NET] reads={}, frames={}, reads/msg={:.3f}, bytes/read={:.1f}, buf grows={}, shrinks={}",
+                reads, frames,
+                frames ? static_cast<double>(reads) / frames : 0.0,
+                reads ? static_cast<double>(bytes) / reads : 0.0,
+                recv.grows.load(std::memory_order_relaxed), recv.shrinks.load(std::memory_order_relaxed));
+
+            auto& send = Session::send_stats();
+            uint64_t writes = send.writes.load(std::memory_order_relaxed);
+            uint64_t sent = send.messages.load(std::memory_order_relaxed);
+            AppContext::instance().logger->info("[NET] writes={}, sent msgs={}, msgs/write={:.2f}, bytes/write={:.1f}",
+                writes, sent,
+                writes ? static_cast<double>(sent) / writes : 0.0,
+                writes ? static_cast<double>(send.bytes.load(std::memory_order_relaxed)) / writes : 0.0);
+
+            // 포맷별 메시지 크기/파싱 비용 (JSON vs MessagePack/CBOR 비교용)
+            for (size_t i = 0; i < kWireFormatCount; ++i) {
+                auto format = static_cast<WireFormat>(i);
+                auto& fs = wire_format_stats(format);
+                uint64_t in = fs.messages_in.load(std::memory_order_relaxed);
+                uint64_t out = fs.messages_out.load(std::memory_order_relaxed);
+                if (in == 0 && out == 0) continue;
+                AppContext::instance().logger->info("[NET] format={} in={}, dom={}, bytes/msg={:.1f}, parse={:.2f}us/msg, out={}, bytes/msg={:.1f}",
+                    wire_format_name(format), in, fs.dom_parses.load(std::memory_order_relaxed),
+                    in ? static_cast<double>(fs.bytes_in.load(std::memory_order_relaxed)) / in : 0.0,
+                    in ? static_cast<double>(fs.parse_ns.load(std::memory_order_relaxed)) / in / 1000.0 : 0.0,
+                    out,
+                    out ? static_cast<double>(fs.bytes_out.load(std::memory_order_relaxed)) / out : 0.0);
+            }
+
+            // 로그 파이프라인: async queue overflow / 카테고리별 샘플링·rate limit 으로 생략된 수
+            auto ls = log_stats();
+            AppContext::instance().logger->info("[LOG] overruns={}, suppressed net={}/{}, session={}/{}, dispatch={}/{}, db={}/{} (sampled/rate-limited)",
+                ls.overruns,
+                ls.sampled_out[0], ls.rate_limited[0], ls.sampled_out[1], ls.rate_limited[1],
+                ls.sampled_out[2], ls.rate_limited[2], ls.sampled_out[3], ls.rate_limited[3]);
+
+            // 3. DB 풀 포화도 + statement 캐시 hit/miss (캐시 크기 조정용)
+            if (auto db = AppContext::instance().db) {
+                auto st = db->stats();
+                AppContext::instance().logger->info("[DB] pool open={}/{}, in_use={}, idle={}, waiters={}, acquires={}, timeouts={}, avg_wait={}us",
+                    st.open, st.max_connections, st.in_use, st.idle, st.waiters, st.acquires, st.timeouts,
+                    st.acquires ? st.wait_sum_us / st.acquires : 0);
+                AppContext::instance().logger->info("[DB] acquire wait histogram(us) <100:{} <500:{} <1ms:{} <5ms:{} <10ms:{} <50ms:{} <100ms:{} <500ms:{} <1s:{} >=1s:{}",
+                    st.wait_buckets[0], st.wait_buckets[1], st.wait_buckets[2], st.wait_buckets[3], st.wait_buckets[4],
+                    st.wait_buckets[5], st.wait_buckets[6], st.wait_buckets[7], st.wait_buckets[8], st.wait_buckets[9]);
+                AppContext::instance().logger->info("[DB] health checks={}, failures={}, replaced={}",
+                    st.health_checks, st.health_failures, st.replaced);
+                AppContext::instance().logger->info("[DB] stmt cache hits={}, misses={}, evictions={}",
+                    db->stmt_cache_hits(), db->stmt_cache_misses(), db->stmt_cache_evictions());
+            }
+
+            start_monitor_loop(); // 반복
         }
         });
 }
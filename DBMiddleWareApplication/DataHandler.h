@@ -35,8 +35,6 @@ private:
 
     boost::asio::steady_timer monitor_timer_; // 모니터링 타이머
 
-    boost::asio::steady_timer cleanup_timer_;  // 비활성 세션 클린업용 타이머
-
 
 public:
     DataHandler(boost::asio::io_context& io, std::shared_ptr<SessionManager> session_manager, const std::string& packet); // 생성자 선언 필요!
@@ -45,7 +43,7 @@ public:
     DataHandler& operator=(const DataHandler&) = delete;
 
     //void dispatch(const std::shared_ptr<Session>& session, const json& msg);
-    void  dispatch(const std::shared_ptr<Session>& session, const std::string& packet);
+    void  dispatch(const std::shared_ptr<Session>& session, std::string_view packet);
     // TCP 세션 관리 
     // 세션 추가
     void add_session(int session_id, std::shared_ptr<Session> session);
@@ -59,14 +57,11 @@ public:
 
     std::shared_ptr<Session> find_session_by_nickname(const std::string& nickname);
 
-    // 글로벌 keepalive 관련
-    void do_keepalive_check();
+    // idle / keepalive 만료는 세션별 타이머 휠 타이머가 처리 (전체 순회 없음)
 
 	// 로그인 하지 않고 DDos 공격하는 세션 정리
-    void cleanup_unauth_sessions(size_t max_unauth); // 미인증 세션 정리
+    size_t cleanup_unauth_sessions(size_t max_unauth); // 미인증(Handshaking) 세션이 max_unauth 를 넘으면 오래된 것부터 종료, 종료 수 반환
 
 	void start_monitor_loop(); // 모니터링 루프 시작 함수
 
-    void start_cleanup_loop();  // 주기적 클린업 시작
-
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+﻿#include "DbExecutor.h"
+#include "MysqlPool.h"
+#include "AppContext.h"
+#include "Logger.h"
+
+DbExecutor::DbExecutor(std::shared_ptr<MySqlPool> pool, size_t worker_count, size_t max_queue)
+    : pool_(std::move(pool)), max_queue_(max_queue)
+{
+    if (worker_count == 0) worker_count = 1;
+    AppContext::instance().logger->info("[DbExecutor] Starting {} workers, max_queue={}", worker_count, max_queue_);
+
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+DbExecutor::~DbExecutor() {
+    stop();
+}
+
+void DbExecutor::stop() {
+    {
+        std::scoped_lock lk(mtx_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+size_t DbExecutor::queue_size() {
+    std::scoped_lock lk(mtx_);
+    return queue_.size();
+}
+
+bool DbExecutor::enqueue(Task task, bool bounded) {
+    {
+        std::scoped_lock lk(mtx_);
+        if (stopping_ || (bounded && queue_.size() >= max_queue_)) {
+            return false;
+        }
+        queue_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+bool DbExecutor::submit_job(Job job) {
+    return enqueue([this, job = std::move(job)]() {
+        auto conn = pool_->acquire();
+        try {
+            job(conn.get());
+        }
+        catch (const mysqlx::Error&) {
+            if (conn) conn->mark_suspect();
+            return_connection(std::move(conn));
+            throw;
+        }
+        return_connection(std::move(conn));
+    }, true);
+}
+
+bool DbExecutor::submit_lease(LeaseJob job) {
+    return enqueue([this, job = std::move(job)]() {
+        job(pool_->acquire());
+    }, true);
+}
+
+bool DbExecutor::submit_continuation(Task task) {
+    return enqueue(std::move(task), false);
+}
+
+void DbExecutor::return_connection(std::unique_ptr<DbConnection> conn) {
+    if (!conn) return;
+    // 실행 중 오류가 난 커넥션은 반납 전에 확인 (죽은 커넥션이 idle 로 돌아가지 않게)
+    if (conn->is_suspect() && !pool_->ping(*conn)) {
+        pool_->discard(std::move(conn));
+        return;
+    }
+    pool_->release(std::move(conn));
+}
+
+void DbExecutor::discard_connection(std::unique_ptr<DbConnection> conn) {
+    pool_->discard(std::move(conn));
+}
+
+bool DbExecutor::submit(Work work, boost::asio::any_io_executor completion_ex, Completion done) {
+    return submit_job([work = std::move(work), ex = std::move(completion_ex), done = std::move(done)](DbConnection* conn) {
+        DbResult result;
+        if (!conn) {
+            result.error = "DB connection unavailable";
+        }
+        else {
+            auto started = std::chrono::steady_clock::now();
+            try {
+                result = work(*conn);
+            }
+            catch (const mysqlx::Error& e) {
+                conn->mark_suspect();   // fetchOne/getColumn 등 execute 이후 단계의 오류도 → 반납 전 ping
+                result.ok = false;
+                result.error = e.what();
+            }
+            catch (const std::exception& e) {
+                result.ok = false;
+                result.error = e.what();
+            }
+            result.started = started;
+            result.finished = std::chrono::steady_clock::now();
+        }
+        // 결과는 반드시 세션 strand 위에서 처리 (네트워크 스레드는 MySQL 대기 없음)
+        boost::asio::post(ex, [done, result = std::move(result)]() {
+            done(result);
+        });
+    });
+}
+
+void DbExecutor::worker_loop(size_t index) {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            cv_.wait(lk, [this]() { return stopping_ || !queue_.empty(); });
+            if (stopping_ && queue_.empty()) break;
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        try {
+            task();
+        }
+        catch (const mysqlx::Error& e) {
+            LOG_SAMPLED(LogCategory::Db, spdlog::level::err, "[DbExecutor] worker {} job DB exception: {}", index, e.what());
+        }
+        catch (const std::exception& e) {
+            LOG_SAMPLED(LogCategory::Db, spdlog::level::err, "[DbExecutor] worker {} job exception: {}", index, e.what());
+        }
+    }
+    AppContext::instance().logger->info("[DbExecutor] worker {} stopped", index);
+}
@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include <string>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+
+class MySqlPool;
+class DbConnection;
+
+// DB 작업 결과 (워커 스레드 → 세션 strand 로 전달)
+struct DbResult {
+    bool ok = false;
+    uint64_t affected_rows = 0;
+    uint64_t last_insert_id = 0;
+    std::string error;
+    std::shared_ptr<const std::string> body;            // 조회 결과 응답 본문 (select: 워커에서 세션 포맷으로 인코딩)
+    std::chrono::steady_clock::time_point started{};    // 커넥션 획득 후 쿼리 시작 (RequestTrace 용)
+    std::chrono::steady_clock::time_point finished{};
+};
+
+// 블로킹 MySQL 호출을 io.run() 네트워크 스레드에서 분리하기 위한 전용 워커 풀
+// - bounded queue: 가득 차면 submit 이 false 반환 (호출자가 busy 응답)
+// - 커넥션은 워커가 MySqlPool::acquire() 로 빌리고 작업 후 release
+// - lease: 커넥션을 job 이 소유해서 여러 워커 작업(continuation)에 걸쳐 사용 (select_stream 등)
+class DbExecutor {
+public:
+    using Work = std::function<DbResult(DbConnection&)>;
+    using Completion = std::function<void(const DbResult&)>;
+    using Job = std::function<void(DbConnection*)>;   // 커넥션 획득 실패 시 nullptr
+    using LeaseJob = std::function<void(std::unique_ptr<DbConnection>)>;   // 커넥션 소유권째 넘김 (획득 실패 시 nullptr)
+    using Task = std::function<void()>;
+
+    DbExecutor(std::shared_ptr<MySqlPool> pool, size_t worker_count, size_t max_queue);
+    ~DbExecutor();
+
+    // 복사/이동 금지
+    DbExecutor(const DbExecutor&) = delete;
+    DbExecutor& operator=(const DbExecutor&) = delete;
+
+    // work 를 워커에서 실행하고, 결과를 completion_ex(보통 세션 strand_)로 post 해서 done 호출
+    bool submit(Work work, boost::asio::any_io_executor completion_ex, Completion done);
+
+    // 저수준: 커넥션만 빌려서 job 실행. 결과 전달은 job 이 직접 책임짐 (배치 등)
+    bool submit_job(Job job);
+
+    // 커넥션을 빌려 job 에 소유권째 넘김. job 은 다 쓰고 나서 return_connection / discard_connection 으로 반드시 돌려줌
+    bool submit_lease(LeaseJob job);
+    // 커넥션 획득 없이 워커에서 실행 (lease 받은 커넥션으로 이어서 작업할 때)
+    // 이미 커넥션을 쥔 작업이라 max_queue 는 적용하지 않음 (stop 이후에만 false)
+    bool submit_continuation(Task task);
+
+    void return_connection(std::unique_ptr<DbConnection> conn);    // suspect 면 ping 해서 반납 또는 폐기
+    void discard_connection(std::unique_ptr<DbConnection> conn);   // 결과를 다 읽지 않은 커넥션 등 → 재사용하지 않고 폐기
+
+    void stop();
+
+    size_t queue_size();
+    size_t max_queue() const { return max_queue_; }
+
+private:
+    void worker_loop(size_t index);
+    bool enqueue(Task task, bool bounded);
+
+private:
+    std::shared_ptr<MySqlPool> pool_;
+    size_t max_queue_ = 0;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<Task> queue_;
+    bool stopping_ = false;
+
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,133 @@
+﻿#include "Epoch.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace {
+    constexpr size_t kSlots = 256;              // 동시에 Guard 를 쓰는 스레드 수 상한 (넘는 스레드는 overflow 경로)
+    constexpr size_t kReclaimThreshold = 64;    // retire 가 이만큼 쌓이면 retire 한 스레드가 바로 회수 시도
+    constexpr uint64_t kIdle = 0;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{ kIdle };   // 읽는 중이면 진입 때의 전역 epoch
+        std::atomic<bool> owned{ false };
+    };
+
+    Slot g_slots[kSlots];
+    std::atomic<uint64_t> g_epoch{ 1 };
+    std::atomic<size_t> g_overflow_readers{ 0 };   // slot 을 못 받은 스레드가 읽는 중이면 회수 보류
+
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> deleter;
+    };
+    std::mutex g_retire_mutex;
+    std::vector<Retired> g_retired;
+    std::atomic<size_t> g_pending{ 0 };
+
+    struct ThreadSlot {
+        Slot* slot = nullptr;
+        size_t depth = 0;
+
+        ThreadSlot() {
+            for (auto& s : g_slots) {
+                bool expected = false;
+                if (!s.owned.load(std::memory_order_relaxed) &&
+                    s.owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    slot = &s;
+                    break;
+                }
+            }
+        }
+        ~ThreadSlot() {
+            if (slot) slot->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    ThreadSlot& thread_slot() {
+        thread_local ThreadSlot ts;
+        return ts;
+    }
+}
+
+namespace epoch {
+
+    Guard::Guard() {
+        auto& ts = thread_slot();
+        if (ts.depth++ > 0) return;
+        if (ts.slot) {
+            ts.slot->epoch.store(g_epoch.load());
+        }
+        else {
+            g_overflow_readers.fetch_add(1);
+        }
+    }
+
+    Guard::~Guard() {
+        auto& ts = thread_slot();
+        if (--ts.depth > 0) return;
+        if (ts.slot) {
+            ts.slot->epoch.store(kIdle, std::memory_order_release);
+        }
+        else {
+            g_overflow_readers.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    // 이전 포인터를 이미 바꿔 놓은 뒤 호출됨 → 이 객체를 볼 수 있는 reader 의 진입 epoch 는 retire epoch 이하
+    // epoch 를 하나 올려 두므로 이후 진입하는 reader 는 이 객체를 막지 않음
+    void retire(std::function<void()> deleter) {
+        uint64_t retired_at = g_epoch.fetch_add(1);
+        size_t pending_now;
+        {
+            std::lock_guard<std::mutex> lock(g_retire_mutex);
+            g_retired.push_back(Retired{ retired_at, std::move(deleter) });
+            pending_now = g_retired.size();
+        }
+        g_pending.fetch_add(1, std::memory_order_relaxed);
+        if (pending_now >= kReclaimThreshold) reclaim();
+    }
+
+    size_t reclaim() {
+        // 후보를 먼저 떼어 낸 뒤 slot 을 읽음 (떼어 낸 뒤 retire 된 것은 이번 검사 대상이 아님)
+        std::vector<Retired> candidates;
+        {
+            std::lock_guard<std::mutex> lock(g_retire_mutex);
+            if (g_retired.empty()) return 0;
+            candidates.swap(g_retired);
+        }
+
+        uint64_t oldest_reader = std::numeric_limits<uint64_t>::max();
+        if (g_overflow_readers.load() != 0) {
+            oldest_reader = 0;   // 누가 읽는지 모름 → 이번에는 하나도 해제하지 않음
+        }
+        else {
+            for (auto& s : g_slots) {
+                uint64_t e = s.epoch.load();
+                if (e != kIdle) oldest_reader = std::min(oldest_reader, e);
+            }
+        }
+
+        auto keep_end = std::partition(candidates.begin(), candidates.end(),
+            [oldest_reader](const Retired& r) { return r.epoch >= oldest_reader; });
+        size_t freed = static_cast<size_t>(candidates.end() - keep_end);
+        for (auto it = keep_end; it != candidates.end(); ++it) {
+            it->deleter();
+        }
+        candidates.erase(keep_end, candidates.end());
+
+        if (!candidates.empty()) {
+            std::lock_guard<std::mutex> lock(g_retire_mutex);
+            g_retired.insert(g_retired.end(), std::make_move_iterator(candidates.begin()), std::make_move_iterator(candidates.end()));
+        }
+        g_pending.fetch_sub(freed, std::memory_order_relaxed);
+        return freed;
+    }
+
+    size_t pending() {
+        return g_pending.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,33 @@
+﻿#pragma once
+#include <cstddef>
+#include <functional>
+
+// 읽기 쪽에 락도 참조 카운트도 없는 RCU 용 epoch 기반 회수
+// - 읽는 쪽: epoch::Guard 가 살아 있는 동안 읽은 포인터는 해제되지 않음 (스레드별 slot 에 진입 epoch 기록, 중첩 가능)
+// - 쓰는 쪽: 새 포인터를 발행한 뒤 이전 객체를 retire → 그 시점에 읽고 있던 Guard 가 모두 끝난 뒤에 해제
+// - 발행/읽기는 기본(seq_cst) atomic load/store 로 할 것 (slot 기록 → 포인터 읽기 순서에 기대므로)
+// - 해제는 retire 가 일정 개수 쌓였을 때, 그리고 reclaim() 호출(모니터 루프) 때 호출한 스레드에서 실행
+namespace epoch {
+
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    // deleter 는 Guard 밖, 락 밖에서 호출됨 (안에서 다시 retire 해도 됨)
+    void retire(std::function<void()> deleter);
+
+    template <typename T>
+    void retire(const T* ptr) {
+        if (ptr) retire([ptr]() { delete ptr; });
+    }
+
+    // 지금 해제할 수 있는 것을 해제하고 개수 반환
+    size_t reclaim();
+
+    // 아직 해제되지 않은 retire 수
+    size_t pending();
+}
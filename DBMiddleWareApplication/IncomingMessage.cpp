@@ -0,0 +1,205 @@
+﻿#include "IncomingMessage.h"
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+namespace {
+    bool is_ws(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    size_t skip_ws(std::string_view s, size_t pos) {
+        while (pos < s.size() && is_ws(s[pos])) ++pos;
+        return pos;
+    }
+
+    // s[pos] == '"' → 닫는 따옴표 다음 위치 (없으면 npos)
+    size_t skip_string(std::string_view s, size_t pos) {
+        ++pos;
+        while (pos < s.size()) {
+            const void* hit = memchr(s.data() + pos, '"', s.size() - pos);
+            if (!hit) return std::string_view::npos;
+            size_t quote = static_cast<const char*>(hit) - s.data();
+            // 앞의 연속된 '\' 개수가 홀수면 escape 된 따옴표
+            size_t backslashes = 0;
+            while (quote - backslashes > pos && s[quote - backslashes - 1] == '\\') ++backslashes;
+            if (backslashes % 2 == 0) return quote + 1;
+            pos = quote + 1;
+        }
+        return std::string_view::npos;
+    }
+
+    // 값 하나를 건너뜀 (객체/배열은 괄호 깊이만 추적, 내용 검증은 DOM 파싱 때)
+    size_t skip_value(std::string_view s, size_t pos) {
+        if (pos >= s.size()) return std::string_view::npos;
+        char c = s[pos];
+        if (c == '"') return skip_string(s, pos);
+        if (c == '{' || c == '[') {
+            int depth = 0;
+            while (pos < s.size()) {
+                char ch = s[pos];
+                if (ch == '"') {
+                    pos = skip_string(s, pos);
+                    if (pos == std::string_view::npos) return pos;
+                    continue;
+                }
+                if (ch == '{' || ch == '[') ++depth;
+                else if (ch == '}' || ch == ']') {
+                    if (--depth == 0) return pos + 1;
+                }
+                ++pos;
+            }
+            return std::string_view::npos;
+        }
+        // 숫자 / true / false / null
+        size_t start = pos;
+        while (pos < s.size() && s[pos] != ',' && s[pos] != '}' && s[pos] != ']' && !is_ws(s[pos])) ++pos;
+        return pos == start ? std::string_view::npos : pos;
+    }
+}
+
+JsonPeekResult json_peek_field(std::string_view s, std::string_view key) {
+    JsonPeekResult result;
+    size_t pos = skip_ws(s, 0);
+    if (pos >= s.size() || s[pos] != '{') return result;
+    pos = skip_ws(s, pos + 1);
+    if (pos < s.size() && s[pos] == '}') {
+        result.ok = true;
+        return result;
+    }
+
+    while (pos < s.size()) {
+        if (s[pos] != '"') return result;
+        size_t key_end = skip_string(s, pos);
+        if (key_end == std::string_view::npos) return result;
+        std::string_view k = s.substr(pos + 1, key_end - pos - 2);
+        if (k.find('\\') != std::string_view::npos) result.escaped_key = true;
+
+        pos = skip_ws(s, key_end);
+        if (pos >= s.size() || s[pos] != ':') return result;
+        pos = skip_ws(s, pos + 1);
+
+        size_t value_end = skip_value(s, pos);
+        if (value_end == std::string_view::npos) return result;
+        if (k == key) {
+            // 중복 key 는 nlohmann 과 같이 마지막 값 → 찾아도 끝까지 스캔
+            result.found = true;
+            result.value = s.substr(pos, value_end - pos);
+        }
+
+        pos = skip_ws(s, value_end);
+        if (pos >= s.size()) return result;
+        if (s[pos] == '}') {
+            result.ok = true;   // 객체 끝까지 확인
+            return result;
+        }
+        if (s[pos] != ',') return result;
+        pos = skip_ws(s, pos + 1);
+    }
+    return result;
+}
+
+IncomingMessage::IncomingMessage(WireFormat format, std::string_view payload)
+    : format_(format), payload_(payload) {
+}
+
+std::optional<std::string_view> IncomingMessage::peek_type() {
+    if (format_ == WireFormat::Json) {
+        auto start = std::chrono::steady_clock::now();
+        JsonPeekResult peek = json_peek_field(payload_, "type");
+        parse_ns_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
+        if (!peek.ok) return std::nullopt;
+        // escape 된 key 가 있으면 "type" 과 같은 key 인지 스캐너로는 모름 → DOM 으로 (드묾)
+        if (!peek.escaped_key) {
+            if (!peek.found || peek.value.size() < 2 || peek.value.front() != '"') return std::string_view{};
+            std::string_view type = peek.value.substr(1, peek.value.size() - 2);
+            if (type.find('\\') == std::string_view::npos) return type;
+            // 값에 escape 포함 (드묾) → 정확한 값은 DOM 으로
+        }
+    }
+
+    // 바이너리 포맷은 스캐너 없음 → DOM 에서 읽음
+    const auto& msg = json();
+    if (!msg.is_object()) return std::nullopt;
+    auto it = msg.find("type");
+    if (it == msg.end() || !it->is_string()) return std::string_view{};
+    return std::string_view(it->get_ref<const std::string&>());
+}
+
+const nlohmann::json& IncomingMessage::json() {
+    if (!dom_) {
+        auto start = std::chrono::steady_clock::now();
+        dom_ = decode_message(format_, payload_);
+        auto finished = std::chrono::steady_clock::now();
+        parse_ns_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(finished - start).count());
+        if (trace_) trace_->set(TraceStage::Parse, finished);
+    }
+    return *dom_;
+}
+
+void IncomingMessage::validate() {
+    if (validated_ || dom_) return;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = nlohmann::json::accept(payload_);   // SAX 검사만 (DOM/할당 없음)
+    parse_ns_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    if (!ok) {
+        json();   // 위치가 담긴 parse_error 를 그대로 던짐
+    }
+    validated_ = true;
+}
+
+std::optional<std::string_view> IncomingMessage::raw_field(std::string_view key) {
+    if (format_ != WireFormat::Json) return std::nullopt;
+    validate();
+    JsonPeekResult peek = json_peek_field(payload_, key);
+    if (!peek.ok || !peek.found || peek.escaped_key) return std::nullopt;
+    return peek.value;
+}
+
+std::string IncomingMessage::string_field(std::string_view key, std::string_view default_value) {
+    if (!dom_ && format_ == WireFormat::Json) {
+        validate();
+        JsonPeekResult peek = json_peek_field(payload_, key);
+        if (peek.ok && !peek.escaped_key && !peek.found) return std::string(default_value);
+        if (peek.ok && !peek.escaped_key && peek.value.size() >= 2 && peek.value.front() == '"'
+            && peek.value.find('\\') == std::string_view::npos) {
+            return std::string(peek.value.substr(1, peek.value.size() - 2));
+        }
+    }
+    const auto& msg = json();
+    if (!msg.is_object()) return std::string(default_value);
+    auto it = msg.find(std::string(key));
+    if (it == msg.end() || !it->is_string()) return std::string(default_value);
+    return it->get<std::string>();
+}
+
+std::optional<int64_t> IncomingMessage::int_field(std::string_view key) {
+    if (!dom_ && format_ == WireFormat::Json) {
+        validate();
+        JsonPeekResult peek = json_peek_field(payload_, key);
+        if (peek.ok && !peek.escaped_key && !peek.found) return std::nullopt;
+        if (peek.ok && !peek.escaped_key) {
+            int64_t value = 0;
+            const char* first = peek.value.data();
+            const char* last = first + peek.value.size();
+            auto [end, ec] = std::from_chars(first, last, value);
+            if (ec == std::errc() && end == last) return value;
+            return std::nullopt;   // 정수가 아님 (문자열, 소수, int64 범위 밖 등)
+        }
+    }
+    const auto& msg = json();
+    if (!msg.is_object()) return std::nullopt;
+    auto it = msg.find(std::string(key));
+    if (it == msg.end()) return std::nullopt;
+    if (it->is_number_unsigned()) {
+        auto v = it->get<uint64_t>();
+        if (v > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) return std::nullopt;
+        return static_cast<int64_t>(v);
+    }
+    if (it->is_number_integer()) return it->get<int64_t>();
+    return std::nullopt;
+}
@@ -0,0 +1,66 @@
+﻿#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+#include "WireFormat.h"
+#include "RequestTrace.h"
+
+// 수신 메시지 1개 (secret 뒤 payload, 수신 버퍼 안의 slice)
+// - JSON 이면 최상위 "type" 만 먼저 스캔해서 핸들러를 고르고, DOM 은 json() 호출 시에만 생성
+// - 필드 하나만 필요하면 string_field()/raw_field()/int_field() 로 DOM 없이 읽을 수 있음
+//   스캐너는 찾는 key 주변만 보므로, 스캔한 값을 돌려주기 전에 payload 전체를 SAX accept 로 한 번 검사
+//   (깨진 JSON 이면 json() 과 같은 parse_error → dispatch 가 세션 종료, 전체 DOM 을 쓸 때와 같은 결과)
+// - MessagePack/CBOR 는 스캐너가 없으므로 처음부터 전체 decode
+// - payload 는 dispatch 호출 동안만 유효 (핸들러가 보관하려면 json() 결과를 복사)
+class IncomingMessage {
+public:
+    IncomingMessage(WireFormat format, std::string_view payload);
+
+    WireFormat format() const { return format_; }
+    std::string_view payload() const { return payload_; }
+
+    // 최상위 "type" 값. nullopt = 형식 오류 (객체가 아님 / 깨진 JSON)
+    std::optional<std::string_view> peek_type();
+
+    // 전체 DOM (첫 호출 시 파싱 후 캐시, 실패 시 nlohmann 예외)
+    const nlohmann::json& json();
+
+    // 최상위 key 의 값 원문 (JSON 만, 예: "\"abc\"", "123", "{...}"), escape 된 key 가 있는 payload 는 nullopt
+    std::optional<std::string_view> raw_field(std::string_view key);
+    // 최상위 문자열 필드 (escape 가 없으면 DOM 없이, 있으면 json() 으로)
+    std::string string_field(std::string_view key, std::string_view default_value = {});
+    // 최상위 정수 필드 (JSON 이면 DOM 없이 원문 숫자를), 없거나 int64 정수가 아니면 nullopt
+    std::optional<int64_t> int_field(std::string_view key);
+
+    // 이후 json() 이 DOM 을 만들면 trace 에 Parse 단계를 찍음 (dispatch 가 type 판별 뒤에 연결)
+    void set_trace(RequestTrace* trace) { trace_ = trace; }
+
+    uint64_t parse_ns() const { return parse_ns_; }   // 스캔 + 파싱에 쓴 시간 (통계용)
+    bool has_dom() const { return dom_.has_value(); }
+
+private:
+    WireFormat format_;
+    std::string_view payload_;
+    std::optional<nlohmann::json> dom_;
+    uint64_t parse_ns_ = 0;
+    RequestTrace* trace_ = nullptr;
+    bool validated_ = false;
+
+    // 스캔 결과를 쓰기 전 payload 전체 형식 검사 (한 번만, DOM 이 있으면 생략). 깨졌으면 parse_error
+    void validate();
+};
+
+// 최상위 JSON 객체에서 key 의 값 원문을 찾는 스캐너 (DOM 생성 없음)
+// - 문자열 안은 memchr 로 건너뜀 (libc 의 벡터화된 구현 사용)
+// - 항상 객체 끝까지 스캔: 같은 key 가 여러 번 나오면 DOM(nlohmann) 과 같이 마지막 값
+// - found=false, ok=true 이면 key 없음 / ok=false 이면 형식 오류
+// - escaped_key=true 이면 escape 가 들어간 key 가 있어서 결과를 믿을 수 없음 (호출자가 DOM 으로)
+struct JsonPeekResult {
+    bool ok = false;
+    bool found = false;
+    bool escaped_key = false;
+    std::string_view value;
+};
+JsonPeekResult json_peek_field(std::string_view json, std::string_view key);
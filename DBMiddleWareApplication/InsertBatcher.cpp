@@ -0,0 +1,226 @@
+﻿#include "InsertBatcher.h"
+#include "AppContext.h"
+#include "Logger.h"
+#include "MysqlPool.h"
+#include "QueryCache.h"
+
+InsertBatcher::InsertBatcher(boost::asio::io_context& io, std::shared_ptr<DbExecutor> executor,
+    size_t max_rows, std::chrono::milliseconds window)
+    : strand_(boost::asio::make_strand(io)),
+    executor_(std::move(executor)),
+    max_rows_(max_rows == 0 ? 1 : max_rows),
+    window_(window)
+{
+    AppContext::instance().logger->info("[InsertBatcher] max_rows={}, window={}ms", max_rows_, window_.count());
+}
+
+void InsertBatcher::add(const std::string& table, nlohmann::json values,
+    boost::asio::any_io_executor completion_ex, Completion done) {
+    boost::asio::dispatch(strand_, [this, table, values = std::move(values),
+        ex = std::move(completion_ex), done = std::move(done)]() mutable {
+        add_on_strand(table, std::move(values), std::move(ex), std::move(done));
+    });
+}
+
+void InsertBatcher::add_on_strand(const std::string& table, nlohmann::json values,
+    boost::asio::any_io_executor completion_ex, Completion done) {
+    // json object 는 키 정렬 상태라 컬럼 순서가 항상 같음 → 같은 컬럼 집합이면 같은 key
+    std::vector<std::string> columns;
+    columns.reserve(values.size());
+    for (auto& [k, v] : values.items()) {
+        columns.push_back(k);
+    }
+    std::string key = make_key(table, columns);
+
+    auto& slot = slots_[key];
+    if (!slot.batch) {
+        slot.batch = std::make_shared<Batch>();
+        slot.batch->table = table;
+        slot.batch->columns = std::move(columns);
+        slot.batch->rows.reserve(max_rows_);
+
+        // 새 배치의 첫 행 → window 타이머 시작
+        slot.timer = std::make_unique<boost::asio::steady_timer>(strand_);
+        uint64_t epoch = slot.epoch = ++next_epoch_;
+        slot.timer->expires_after(window_);
+        slot.timer->async_wait([this, key, epoch](const boost::system::error_code& ec) {
+            if (ec) return;
+            auto it = slots_.find(key);
+            if (it != slots_.end() && it->second.epoch == epoch) {
+                flush(key);
+            }
+        });
+    }
+
+    slot.batch->rows.push_back(PendingRow{ std::move(values), std::move(completion_ex), std::move(done) });
+
+    if (slot.batch->rows.size() >= max_rows_) {
+        flush(key);
+    }
+}
+
+void InsertBatcher::flush(const std::string& key) {
+    auto it = slots_.find(key);
+    if (it == slots_.end() || !it->second.batch) return;
+
+    auto batch = std::move(it->second.batch);
+    slots_.erase(it);   // 타이머도 같이 해제 (대기 중인 콜백은 aborted 또는 epoch 불일치로 무시)
+
+    execute(std::move(batch));
+}
+
+void InsertBatcher::execute(std::shared_ptr<Batch> batch) {
+    size_t row_count = batch->rows.size();
+    bool queued = executor_->submit_job([batch, max_rows = max_rows_](DbConnection* conn) {
+        std::vector<DbResult> results(batch->rows.size());
+
+        if (!conn) {
+            for (auto& r : results) r.error = "DB connection unavailable";
+        }
+        else {
+            auto started = std::chrono::steady_clock::now();
+            size_t rows = batch->rows.size();
+            bool committed = false;
+            std::vector<size_t> sizes = chunk_sizes(rows, max_rows);
+            std::vector<uint64_t> first_ids(sizes.size(), 0);   // 청크별 첫 행 id
+            try {
+                conn->session().startTransaction();
+                size_t offset = 0;
+                for (size_t c = 0; c < sizes.size(); ++c) {
+                    size_t count = sizes[c];
+                    auto res = conn->execute(make_shape_key("insert", batch->table, batch->columns, count),
+                        [&]() { return build_insert_shape(batch->table, batch->columns, count); },
+                        collect_params(*batch, offset, count));
+                    first_ids[c] = res.getAutoIncrementValue();
+                    offset += count;
+                }
+                conn->session().commit();
+                committed = true;
+            }
+            catch (const std::exception& e) {
+                if (!rollback_batch(*conn)) {
+                    // 일부 행이 이미 반영됐을 수 있음 (non-transactional 엔진 / 커넥션 오류) → 재시도하면 중복 insert
+                    LOG_SAMPLED(LogCategory::Db, spdlog::level::err, "[InsertBatcher] batch insert failed and could not be rolled back cleanly (table={}, rows={}): {}",
+                        batch->table, rows, e.what());
+                    for (auto& r : results) {
+                        r.ok = false;
+                        r.error = std::string("batch insert failed, rows may be partially applied: ") + e.what();
+                    }
+                }
+                else {
+                    // 한 행 때문에 배치 전체가 실패 (rollback 완료) → 행 단위로 재시도해서 각자 정확한 결과 전달
+                    LOG_SAMPLED(LogCategory::Db, spdlog::level::warn, "[InsertBatcher] batch insert failed (table={}, rows={}), retrying per row: {}",
+                        batch->table, rows, e.what());
+                    for (size_t i = 0; i < rows; ++i) {
+                        try {
+                            auto res = conn->execute(make_shape_key("insert", batch->table, batch->columns, 1),
+                                [&]() { return build_insert_shape(batch->table, batch->columns, 1); },
+                                collect_params(*batch, i, 1));
+                            results[i].ok = true;
+                            results[i].affected_rows = res.getAffectedItemsCount();
+                            results[i].last_insert_id = res.getAutoIncrementValue();
+                        }
+                        catch (const std::exception& row_err) {
+                            results[i].ok = false;
+                            results[i].error = row_err.what();
+                        }
+                    }
+                }
+            }
+
+            if (committed) {
+                // multi-row INSERT 는 행 수를 미리 아는 simple insert → auto increment 값이 청크의 첫 행부터 연속 할당
+                // 청크 안 행 i 의 id = 청크 첫 id + i × auto_increment_increment (id 를 생성하지 않았으면 0)
+                uint64_t step = 0;
+                size_t offset = 0;
+                for (size_t c = 0; c < sizes.size(); ++c) {
+                    if (first_ids[c] != 0 && step == 0) step = conn->auto_increment_increment();
+                    for (size_t i = 0; i < sizes[c]; ++i) {
+                        auto& r = results[offset + i];
+                        r.ok = true;
+                        r.affected_rows = 1;
+                        r.last_insert_id = first_ids[c] != 0 ? first_ids[c] + i * step : 0;
+                    }
+                    offset += sizes[c];
+                }
+            }
+            invalidate_cached_table(batch->table);   // 일부 행만 성공했어도 테이블은 바뀜
+
+            // 배치 안의 행은 같은 쿼리를 공유 → 시작/끝도 배치 단위
+            auto finished = std::chrono::steady_clock::now();
+            for (auto& r : results) {
+                r.started = started;
+                r.finished = finished;
+            }
+        }
+
+        for (size_t i = 0; i < batch->rows.size(); ++i) {
+            complete(batch->rows[i], results[i]);
+        }
+    });
+
+    if (!queued) {
+        LOG_SAMPLED(LogCategory::Db, spdlog::level::warn, "[InsertBatcher] DB queue full! dropping batch table={}, rows={}", batch->table, row_count);
+        DbResult busy;
+        busy.error = "DB queue full";
+        for (auto& row : batch->rows) {
+            complete(row, busy);
+        }
+    }
+}
+
+void InsertBatcher::complete(const PendingRow& row, const DbResult& result) {
+    boost::asio::post(row.completion_ex, [done = row.done, result]() {
+        done(result);
+    });
+}
+
+// 실패한 배치 트랜잭션 되돌리기. 되돌리지 못한 변경이 있으면(경고) 또는 커넥션 오류면 false
+bool InsertBatcher::rollback_batch(DbConnection& conn) {
+    try {
+        auto res = conn.session().sql("ROLLBACK").execute();
+        return res.getWarningsCount() == 0;   // 1196: Some non-transactional changed tables couldn't be rolled back
+    }
+    catch (const mysqlx::Error&) {
+        conn.mark_suspect();
+        return false;
+    }
+}
+
+std::string InsertBatcher::make_key(const std::string& table, const std::vector<std::string>& columns) {
+    std::string key = table;
+    for (auto& c : columns) {
+        key += '\x1f';
+        key += c;
+    }
+    return key;
+}
+
+// 배치 행 수 → statement 별 행 수 (max_rows 를 먼저, 나머지는 2의 거듭제곱으로 큰 것부터)
+// 예: max_rows=100 이면 100 → [100], 45 → [32, 8, 4, 1]
+std::vector<size_t> InsertBatcher::chunk_sizes(size_t rows, size_t max_rows) {
+    std::vector<size_t> sizes;
+    while (rows >= max_rows) {
+        sizes.push_back(max_rows);
+        rows -= max_rows;
+    }
+    while (rows > 0) {
+        size_t chunk = 1;
+        while (chunk * 2 <= rows) chunk *= 2;
+        sizes.push_back(chunk);
+        rows -= chunk;
+    }
+    return sizes;
+}
+
+std::vector<mysqlx::Value> InsertBatcher::collect_params(const Batch& batch, size_t first, size_t count) {
+    // 행 순서 × 컬럼 순서대로 평탄화 (build_insert_shape 의 placeholder 순서와 동일)
+    std::vector<mysqlx::Value> params;
+    params.reserve(count * batch.columns.size());
+    for (size_t i = first; i < first + count; ++i) {
+        for (const auto& col : batch.columns) {
+            params.push_back(json_to_db_value(batch.rows[i].values[col]));
+        }
+    }
+    return params;
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <chrono>
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <nlohmann/json.hpp>
+#include "DbExecutor.h"
+
+// MySQL Connector/C++ 8.x (X DevAPI)
+#include <mysqlx/xdevapi.h>
+
+// 같은 (table, 컬럼 집합)으로 들어오는 단건 insert 를 모아서
+// 한 번의 multi-row INSERT ... VALUES (...),(...) 로 실행하는 배칭 단계
+// - window(ms) 가 지나거나 max_rows 에 도달하면 flush
+// - 배치는 max_rows 또는 2의 거듭제곱 행 수 단위 statement 로 나눠 실행 (같은 트랜잭션)
+//   → (table, 컬럼 집합)마다 SQL 모양이 log2(max_rows) + 2 개 이하라 커넥션별 statement 캐시를 밀어내지 않음
+// - 결과는 각 요청의 completion executor(세션 strand_)로 행 단위로 돌려줌
+// - 배치는 트랜잭션 안에서 실행, 실패하면 rollback 이 깨끗하게 끝난 경우에만 행 단위로 재시도
+//   (non-transactional 엔진이라 일부 행이 이미 들어갔으면 재시도하지 않고 배치 전체를 실패로 응답)
+class InsertBatcher {
+public:
+    using Completion = DbExecutor::Completion;
+
+    InsertBatcher(boost::asio::io_context& io, std::shared_ptr<DbExecutor> executor,
+        size_t max_rows, std::chrono::milliseconds window);
+
+    // 복사/이동 금지
+    InsertBatcher(const InsertBatcher&) = delete;
+    InsertBatcher& operator=(const InsertBatcher&) = delete;
+
+    // 1행 추가 (어느 스레드에서 호출해도 됨, 내부는 strand 로 직렬화)
+    void add(const std::string& table, nlohmann::json values,
+        boost::asio::any_io_executor completion_ex, Completion done);
+
+private:
+    struct PendingRow {
+        nlohmann::json values;
+        boost::asio::any_io_executor completion_ex;
+        Completion done;
+    };
+
+    struct Batch {
+        std::string table;
+        std::vector<std::string> columns;
+        std::vector<PendingRow> rows;
+    };
+
+    // 모으는 중인 배치 1개 (flush 하면 slot 째로 지움 → 클라이언트가 보낸 컬럼 조합 수만큼 쌓이지 않음)
+    struct Slot {
+        std::shared_ptr<Batch> batch;
+        std::unique_ptr<boost::asio::steady_timer> timer;
+        uint64_t epoch = 0;   // 오래된 타이머 콜백이 같은 key 의 새 배치를 flush 하지 않도록
+    };
+
+    void add_on_strand(const std::string& table, nlohmann::json values,
+        boost::asio::any_io_executor completion_ex, Completion done);
+    void flush(const std::string& key);
+    void execute(std::shared_ptr<Batch> batch);
+
+    static std::string make_key(const std::string& table, const std::vector<std::string>& columns);
+    static std::vector<mysqlx::Value> collect_params(const Batch& batch, size_t first, size_t count);
+    static std::vector<size_t> chunk_sizes(size_t rows, size_t max_rows);
+    static void complete(const PendingRow& row, const DbResult& result);
+    static bool rollback_batch(DbConnection& conn);
+
+private:
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    std::shared_ptr<DbExecutor> executor_;
+    size_t max_rows_;
+    std::chrono::milliseconds window_;
+
+    std::unordered_map<std::string, Slot> slots_;   // strand_ 위에서만 접근, window 안에 열린 배치만
+    uint64_t next_epoch_ = 0;                        // slot 이 지워졌다 다시 생겨도 epoch 이 겹치지 않게 전체 공용
+};
@@ -0,0 +1,69 @@
+﻿#include "IoContextPool.h"
+#include "AppContext.h"
+#include "Logger.h"
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+IoContextPool::IoContextPool(size_t context_count, size_t threads_per_context, bool pin_threads)
+    : threads_per_context_(threads_per_context == 0 ? 1 : threads_per_context),
+    pin_threads_(pin_threads) {
+    if (context_count == 0) context_count = 1;
+    contexts_.reserve(context_count);
+    work_guards_.reserve(context_count);
+    for (size_t i = 0; i < context_count; ++i) {
+        // 스레드 1개만 run 한다는 힌트 (다른 스레드에서의 post 는 그대로 안전)
+        int hint = threads_per_context_ == 1 ? 1 : BOOST_ASIO_CONCURRENCY_HINT_DEFAULT;
+        contexts_.push_back(std::make_unique<boost::asio::io_context>(hint));
+        work_guards_.push_back(boost::asio::make_work_guard(*contexts_.back()));
+    }
+}
+
+boost::asio::io_context& IoContextPool::next() {
+    return *contexts_[next_.fetch_add(1, std::memory_order_relaxed) % contexts_.size()];
+}
+
+void IoContextPool::run() {
+    std::vector<std::thread> threads;
+    threads.reserve(contexts_.size() * threads_per_context_);
+    for (size_t i = 0; i < contexts_.size(); ++i) {
+        for (size_t t = 0; t < threads_per_context_; ++t) {
+            size_t cpu = i * threads_per_context_ + t;
+            threads.emplace_back([this, i, cpu]() {
+#if defined(__linux__)
+                unsigned cores = std::thread::hardware_concurrency();   // 알 수 없으면 0
+                if (pin_threads_ && cores > 0) {
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    CPU_SET(cpu % cores, &set);
+                    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+                }
+#else
+                (void)cpu;
+#endif
+                LOG_DEBUG("[DEBUG] io.run() 스레드 진입! context={}", i);
+                // 핸들러 예외로 run() 이 빠져나와도 io_context 는 멈춘 게 아님 → 다시 run
+                // (per_core 는 context 당 스레드 1개라 여기서 끝나면 그 context 의 세션이 전부 멈춤)
+                for (;;) {
+                    try {
+                        contexts_[i]->run();
+                        break;   // stop() 또는 할 일이 없어서 정상 종료
+                    }
+                    catch (const std::exception& e) {
+                        AppContext::instance().logger->error("[io_context] context={} 핸들러 예외, run 재진입: {}", i, e.what());
+                    }
+                    catch (...) {
+                        AppContext::instance().logger->error("[io_context] context={} 알 수 없는 핸들러 예외, run 재진입", i);
+                    }
+                }
+                });
+        }
+    }
+    for (auto& t : threads) t.join();
+}
+
+void IoContextPool::stop() {
+    for (auto& guard : work_guards_) guard.reset();
+    for (auto& ctx : contexts_) ctx->stop();
+}
@@ -0,0 +1,35 @@
+﻿#pragma once
+#include <boost/asio.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+// 네트워크 스레드 실행 모델
+// - shared   : io_context 1개를 스레드 N개가 함께 run (기존 방식)
+// - per_core : 코어마다 io_context 1개 + 스레드 1개 (세션은 accept 된 io_context 에 고정)
+//   다른 코어의 세션으로 가는 작업은 그 세션 strand 로 post (= 해당 io_context 큐로 메시지 전달)
+class IoContextPool {
+public:
+    IoContextPool(size_t context_count, size_t threads_per_context, bool pin_threads);
+
+    IoContextPool(const IoContextPool&) = delete;
+    IoContextPool& operator=(const IoContextPool&) = delete;
+
+    size_t size() const { return contexts_.size(); }
+    boost::asio::io_context& get(size_t index) { return *contexts_[index]; }
+    boost::asio::io_context& next();   // round-robin (단일 acceptor 로 코어에 분배할 때)
+
+    // 모든 스레드 시작 후 종료될 때까지 대기
+    void run();
+    void stop();
+
+private:
+    using WorkGuard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts_;
+    std::vector<WorkGuard> work_guards_;   // accept 대기 전이라도 run() 이 바로 끝나지 않도록
+    size_t threads_per_context_;
+    bool pin_threads_;
+    std::atomic<size_t> next_{ 0 };
+};
@@ -1,10 +1,33 @@
 ﻿#include "Logger.h"
 #include <vector>
+#include <atomic>
+#include <chrono>
 #include "AppContext.h"
+#include "Config.h"
 
+namespace {
+    struct CategoryState {
+        std::atomic<uint32_t> sample_every{ 1 };
+        std::atomic<uint32_t> max_per_sec{ 0 };
+        std::atomic<uint64_t> seq{ 0 };
+        std::atomic<int64_t> window_sec{ 0 };
+        std::atomic<uint32_t> window_count{ 0 };
+        std::atomic<uint64_t> sampled_out{ 0 };
+        std::atomic<uint64_t> rate_limited{ 0 };
+    };
+
+    std::array<CategoryState, kLogCategoryCount> g_categories;
+
+    constexpr std::array<const char*, kLogCategoryCount> kCategoryNames{ "net", "session", "dispatch", "db" };
+}
+
+const char* log_category_name(LogCategory category) {
+    return kCategoryNames[static_cast<size_t>(category)];
+}
 
 void init_logger() {
     if (!AppContext::instance().logger) {
+        auto config = current_config();
         auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("server.log", false);
 
         //콘솔창에 로그 찍고 싶으면 아래 주석 풀기
@@ -12,14 +35,81 @@ void init_logger() {
         //std::vector<spdlog::sink_ptr> sinks{ file_sink, console_sink };
 
         std::vector<spdlog::sink_ptr> sinks{ file_sink };
-        auto logger = std::make_shared<spdlog::logger>("server", sinks.begin(), sinks.end());
+        std::shared_ptr<spdlog::logger> logger;
+        if (config->log_async) {
+            // 백그라운드 writer 스레드 1개 → 파일 쓰기/flush 는 전부 이 스레드에서
+            spdlog::init_thread_pool(config->log_queue_size, 1);
+            logger = std::make_shared<spdlog::async_logger>("server", sinks.begin(), sinks.end(),
+                spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+        }
+        else {
+            logger = std::make_shared<spdlog::logger>("server", sinks.begin(), sinks.end());
+        }
 
         logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
         logger->set_level(spdlog::level::info);
-        logger->flush_on(spdlog::level::info);
+        logger->flush_on(spdlog::level::from_str(config->log_flush_level));   // 기본 warn: info 는 주기 flush 에 맡김
 
         spdlog::register_logger(logger);
+        spdlog::flush_every(config->log_flush_interval);
         AppContext::instance().logger = logger;
+
+        configure_log_categories(config->log_categories);
+        logger->info("[Logger] async={}, queue={}, flush_on={}, flush_every={}s",
+            config->log_async, config->log_queue_size, config->log_flush_level, config->log_flush_interval.count());
+    }
+}
+
+void configure_log_categories(const nlohmann::json& settings) {
+    for (size_t i = 0; i < kLogCategoryCount; ++i) {
+        auto& st = g_categories[i];
+        uint32_t sample_every = 1;
+        uint32_t max_per_sec = 0;
+        if (settings.is_object() && settings.contains(kCategoryNames[i])) {
+            const auto& cat = settings[kCategoryNames[i]];
+            sample_every = std::max<uint32_t>(1, cat.value("sample_every", 1u));
+            max_per_sec = cat.value("max_per_sec", 0u);
+        }
+        st.sample_every.store(sample_every, std::memory_order_relaxed);
+        st.max_per_sec.store(max_per_sec, std::memory_order_relaxed);
     }
 }
 
+bool log_category_allow(LogCategory category) {
+    auto& st = g_categories[static_cast<size_t>(category)];
+
+    // 1. 샘플링: N개 중 1개
+    uint32_t every = st.sample_every.load(std::memory_order_relaxed);
+    if (every > 1 && st.seq.fetch_add(1, std::memory_order_relaxed) % every != 0) {
+        st.sampled_out.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 2. 초당 상한 (1초 고정 window, window 교체 경합은 근사치로 허용)
+    uint32_t max_per_sec = st.max_per_sec.load(std::memory_order_relaxed);
+    if (max_per_sec > 0) {
+        int64_t now_sec = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t window = st.window_sec.load(std::memory_order_relaxed);
+        if (window != now_sec && st.window_sec.compare_exchange_strong(window, now_sec, std::memory_order_relaxed)) {
+            st.window_count.store(0, std::memory_order_relaxed);
+        }
+        if (st.window_count.fetch_add(1, std::memory_order_relaxed) >= max_per_sec) {
+            st.rate_limited.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    return true;
+}
+
+LogStats log_stats() {
+    LogStats stats;
+    if (auto tp = spdlog::thread_pool()) {
+        stats.overruns = tp->overrun_counter();
+    }
+    for (size_t i = 0; i < kLogCategoryCount; ++i) {
+        stats.sampled_out[i] = g_categories[i].sampled_out.load(std::memory_order_relaxed);
+        stats.rate_limited[i] = g_categories[i].rate_limited.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
@@ -1,8 +1,50 @@
 ﻿#pragma once
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <nlohmann/json.hpp>
+#include "AppContext.h"
 
+// config 의 log_* 값으로 로거 생성 (load_config 이후에 호출)
+// - log_async=true: spdlog async 로거 (고정 크기 ring buffer + 백그라운드 writer 1개)
+//   queue 가 차면 가장 오래된 로그를 버림 (호출 스레드는 절대 블록되지 않음, 버린 수는 log_stats().overruns)
+// - flush 는 log_flush_level 이상 또는 log_flush_interval_sec 마다
 void init_logger();
 
+// 패킷당 찍히는 로그의 분류 (카테고리별로 샘플링/초당 상한)
+enum class LogCategory : uint8_t { Net = 0, Session, Dispatch, Db, Count };
+constexpr size_t kLogCategoryCount = static_cast<size_t>(LogCategory::Count);
+
+// 카테고리 설정 적용: {"net": {"sample_every": 100, "max_per_sec": 50}, ...}
+// sample_every=N → N개 중 1개만, max_per_sec=M → 초당 M개까지 (0 = 제한 없음)
+void configure_log_categories(const nlohmann::json& settings);
+
+// 샘플링/rate limit 통과 여부 (lock-free, 통과 못 하면 카운트만)
+bool log_category_allow(LogCategory category);
+
+struct LogStats {
+    uint64_t overruns = 0;                                  // async queue overflow 로 버린 로그
+    std::array<uint64_t, kLogCategoryCount> sampled_out{};  // 샘플링으로 생략
+    std::array<uint64_t, kLogCategoryCount> rate_limited{}; // 초당 상한 초과로 생략
+};
+LogStats log_stats();
+const char* log_category_name(LogCategory category);
+
+// 카테고리별 샘플링/rate limit 을 거치는 로그 (통과 못 하면 포맷팅도 안 함)
+#define LOG_SAMPLED(category, level, ...) \
+    do { \
+        if (log_category_allow(category)) AppContext::instance().logger->log(level, __VA_ARGS__); \
+    } while (0)
+
+// [DEBUG]/[TRACK] 로그: DBMW_ENABLE_DEBUG_LOG 로 빌드했을 때만 존재 (release 에서는 인자 평가도 없음)
+#if defined(DBMW_ENABLE_DEBUG_LOG)
+#define LOG_DEBUG(...) AppContext::instance().logger->info(__VA_ARGS__)
+#define LOG_TRACK(...) AppContext::instance().logger->info(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#define LOG_TRACK(...) ((void)0)
+#endif
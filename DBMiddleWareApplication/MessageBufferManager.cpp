@@ -16,31 +16,63 @@ void MessageBufferManager::append(const char* data, size_t len) {
     //}
     //std::cout << std::endl;
 
-    buffer_.append(data, len);
+    auto dst = prepare(len);
+    memcpy(dst.data(), data, len);
+    commit(len);
 }
 
-std::optional<std::string> MessageBufferManager::extract_message() {
-    constexpr uint32_t MAX_PACKET_SIZE = 4096;  // 원하는 크기로 설정
+boost::asio::mutable_buffer MessageBufferManager::prepare(size_t min_size) {
+    if (storage_.size() - tail_ < min_size) {
+        // 1) 앞쪽 소비된 공간 회수 (남은 미완성 프레임만 앞으로 이동)
+        if (head_ > 0) {
+            size_t remain = tail_ - head_;
+            if (remain > 0) memmove(storage_.data(), storage_.data() + head_, remain);
+            head_ = 0;
+            tail_ = remain;
+        }
+        // 2) 그래도 모자라면 확장
+        if (storage_.size() - tail_ < min_size) {
+            storage_.resize(tail_ + min_size);
+        }
+    }
+    return boost::asio::mutable_buffer(storage_.data() + tail_, storage_.size() - tail_);
+}
+
+void MessageBufferManager::commit(size_t n) {
+    tail_ += n;
+}
+
+std::optional<std::string_view> MessageBufferManager::extract_message() {
     last_clear_by_invalid_length_ = false;      // 호출 시마다 초기화
 
-    if (buffer_.size() < 4) return std::nullopt;
+    if (tail_ - head_ < 4) {
+        if (head_ == tail_) head_ = tail_ = 0;  // 전부 소비했으면 이동 없이 처음부터 재사용
+        return std::nullopt;
+    }
     uint32_t len;
-    memcpy(&len, buffer_.data(), 4);
+    memcpy(&len, storage_.data() + head_, 4);
     len = ntohl(len);
 
     // 길이 유효성 검사 추가!
-    if (len == 0 || len > MAX_PACKET_SIZE) {
+    if (len == 0 || len > max_packet_size_) {
         // 비정상 패킷 길이 → 방어 코드!
-        buffer_.clear();  // 버퍼 파기 (DoS 방지)
+        clear();  // 버퍼 파기 (DoS 방지)
         // 추가: 로그 남기기(이 함수에 logger 접근권한 없으면 호출부에서)
         last_clear_by_invalid_length_ = true;  // 비정상 길이 감지!
         return std::nullopt;
     }
 
-    if (buffer_.size() < 4 + len) return std::nullopt;
-    std::string msg = buffer_.substr(4, len);
-    buffer_ = buffer_.substr(4 + len);
+    if (tail_ - head_ < 4 + static_cast<size_t>(len)) return std::nullopt;
+    std::string_view msg(storage_.data() + head_ + 4, len);
+    head_ += 4 + len;
     return msg;
 }
 
-void MessageBufferManager::clear() { buffer_.clear(); }
+void MessageBufferManager::clear() { head_ = tail_ = 0; }
+
+bool MessageBufferManager::shrink_to(size_t target) {
+    if (head_ != tail_ || storage_.size() <= target) return false;
+    std::vector<char>(target).swap(storage_);   // 실제 메모리까지 반환
+    head_ = tail_ = 0;
+    return true;
+}
@@ -1,14 +1,41 @@
 ﻿#pragma once
 #include <string>
+#include <string_view>
 #include <optional>
+#include <vector>
+#include <boost/asio/buffer.hpp>
 
 // 데이터 나눠 받기 위한 메시지 버퍼 관리 클래스 그리고 패킷 첫 부분에 사이즈 검출
+// - 연속된 하나의 버퍼 [head_, tail_) 에 수신 데이터를 쌓고, 프레임은 복사 없이 string_view 로 꺼냄
+// - 소비된 앞부분은 바로 지우지 않고, 꼬리 공간이 모자랄 때만 한 번에 당겨옴(lazy compaction)
+// - 소켓은 prepare() 로 받은 꼬리 공간에 직접 읽고 commit() 으로 확정
 class MessageBufferManager {
-    std::string buffer_;
+    std::vector<char> storage_;
+    size_t head_ = 0;                               // 아직 처리 안 된 데이터 시작
+    size_t tail_ = 0;                               // 유효 데이터 끝 (= 다음 쓰기 위치)
     bool last_clear_by_invalid_length_ = false;
+    uint32_t max_packet_size_ = kDefaultMaxPacketSize;   // 이보다 긴 길이 프리픽스는 비정상으로 보고 버퍼 파기
 public:
+    static constexpr size_t kDefaultCapacity = 8192;
+    static constexpr uint32_t kDefaultMaxPacketSize = 4096;
+
+    MessageBufferManager() : storage_(kDefaultCapacity) {}
+
     void append(const char* data, size_t len);
-    std::optional<std::string> extract_message();
+
+    // 최소 min_size 바이트 이상의 빈 꼬리 공간을 돌려줌 (필요하면 compact/grow)
+    boost::asio::mutable_buffer prepare(size_t min_size);
+    // prepare() 로 받은 공간에 n 바이트를 채웠음을 확정
+    void commit(size_t n);
+
+    // 완성된 프레임 하나 (길이 프리픽스 제외). 반환된 view 는 다음 append/prepare 전까지만 유효
+    std::optional<std::string_view> extract_message();
     void clear();
+    void set_max_packet_size(uint32_t size) { max_packet_size_ = size; }
+    uint32_t max_packet_size() const { return max_packet_size_; }
+    // 비어 있을 때만 저장 공간을 target 크기로 줄임 (유휴 세션 메모리 반환)
+    bool shrink_to(size_t target);
+    size_t size() const { return tail_ - head_; }
+    size_t capacity() const { return storage_.size(); }
     bool was_last_clear_by_invalid_length() const { return last_clear_by_invalid_length_; }
-};
\ No newline at end of file
+};
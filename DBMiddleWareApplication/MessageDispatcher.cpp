@@ -7,45 +7,165 @@
 #include "Utility.h"
 #include "AppContext.h"
 #include "MysqlPool.h"
+#include "DbExecutor.h"
+#include "InsertBatcher.h"
+#include "WireFormat.h"
+#include "IncomingMessage.h"
+#include "MessageType.h"
+#include "Config.h"
+#include "Metrics.h"
+#include "QueryCache.h"
+#include "SelectStream.h"
+#include <algorithm>
+#include <limits>
+#include <chrono>
 
-MessageDispatcher::MessageDispatcher(DataHandler* handler, SessionManager* sessionmanager, const std::string& secret) : handler_(handler), session_manager_(sessionmanager), secret_(secret) {
-    ///////////// TCP 메시지 핸들러 등록 /////////////
-    // 1) GENERIC: 미리 준비한 SQL + params 바인딩
-
-    register_handler("insert", [this](std::shared_ptr<Session> session, const nlohmann::json& msg) {
-        AppContext::instance().logger->info("[DEBUG] handler msg: {}", msg.dump());
-        std::string table = msg.value("table", "");
-        nlohmann::json values = msg.value("values", nlohmann::json::object());
-        AppContext::instance().logger->info("[DEBUG] handler values: {}", values.dump());
-
-        std::ostringstream oss;
-        oss << "INSERT INTO " << table << " (";
-        bool first = true;
-        for (auto& [k, v] : values.items()) {
-            AppContext::instance().logger->info("[DEBUG][insert] key={}, type={}", k, v.type_name());
-            if (!first) oss << ", ";
-            oss << k;
-            first = false;
-        }
-        oss << ") VALUES (";
-        first = true;
-        for (auto& [k, v] : values.items()) {
-            if (!first) oss << ", ";
-            // 타입에 상관없이 string으로 변환
-            if (v.is_string()) {
-                oss << "'" << v.get<std::string>() << "'";
+namespace {
+    // 고정 응답: 프로세스 시작 후 한 번만 만들어 모든 세션이 공유 (할당 0)
+    const PreframedReply& ack_db_unavailable() {
+        static const PreframedReply ref(R"({"type":"insert_ack","result":"fail","msg":"DB not available"})" "\n");
+        return ref;
+    }
+    const PreframedReply& ack_invalid_identifier() {
+        static const PreframedReply ref(R"({"type":"insert_ack","result":"fail","msg":"Invalid table or column name"})" "\n");
+        return ref;
+    }
+    const PreframedReply& ack_busy() {
+        static const PreframedReply ref(R"({"type":"insert_ack","result":"busy"})" "\n");
+        return ref;
+    }
+    const PreframedReply& ack_ok_single_row() {
+        static const PreframedReply ref(R"({"affected_rows":1,"result":"ok","type":"insert_ack"})" "\n");
+        return ref;
+    }
+    const PreframedReply& select_invalid_request() {
+        static const PreframedReply ref(R"({"type":"select_result","result":"fail","msg":"Invalid table, column or where clause"})" "\n");
+        return ref;
+    }
+    const PreframedReply& select_db_unavailable() {
+        static const PreframedReply ref(R"({"type":"select_result","result":"fail","msg":"DB not available"})" "\n");
+        return ref;
+    }
+    const PreframedReply& select_busy() {
+        static const PreframedReply ref(R"({"type":"select_result","result":"busy"})" "\n");
+        return ref;
+    }
+    const PreframedReply& stream_invalid_request() {
+        static const PreframedReply ref(R"({"type":"rows_end","result":"fail","msg":"Invalid table, column or where clause"})" "\n");
+        return ref;
+    }
+    const PreframedReply& stream_db_unavailable() {
+        static const PreframedReply ref(R"({"type":"rows_end","result":"fail","msg":"DB not available"})" "\n");
+        return ref;
+    }
+    const PreframedReply& stream_busy() {
+        static const PreframedReply ref(R"({"type":"rows_end","result":"busy"})" "\n");
+        return ref;
+    }
+    const PreframedReply& error_hello_not_first() {
+        static const PreframedReply ref(R"({"type":"error","msg":"hello must be the first message."})" "\n");
+        return ref;
+    }
+    const PreframedReply& error_unsupported_format() {
+        static const PreframedReply ref(R"({"type":"error","msg":"Unsupported format."})" "\n");
+        return ref;
+    }
+    const PreframedReply& error_unknown_type() {
+        static const PreframedReply ref(R"({"type":"error","msg":"Unknown message type."})" "\n");
+        return ref;
+    }
+    const PreframedReply& error_parse_failed() {
+        static const PreframedReply ref(R"({"type":"error","msg":"Message parsing failed"})" "\n");
+        return ref;
+    }
+
+    // 요청에 req_id 가 있으면 응답에 같은 값을 실어 보냄 (클라이언트가 응답 순서와 무관하게 요청과 짝지음)
+    // 없으면 상수 응답 그대로, 있으면 본문 앞에 끼워 넣은 사본
+    OutboundRef reply_for(const PreframedReply& reply, WireFormat format, std::optional<int64_t> req_id) {
+        const OutboundRef& ref = reply.get(format);
+        return req_id ? encode_with_request_id(format, ref.body(), *req_id) : ref;
+    }
+
+    // select / select_stream 공통 요청: {"table":"t","columns":["a","b"],"where":{"id":1}}
+    struct SelectQuery {
+        std::string table;
+        std::vector<std::string> columns;                          // 비면 *
+        std::vector<std::string> where_columns;                    // json object 순서 (정렬됨)
+        nlohmann::json where_values = nlohmann::json::array();     // 캐시 key 용
+        std::vector<mysqlx::Value> params;                         // where 값 (limit 는 호출자가 뒤에 추가)
+    };
+
+    // 테이블/컬럼명은 식별자 검사, where 값은 bind (SQL 인젝션 방지). 형식이 틀리면 false
+    bool parse_select_query(const nlohmann::json& msg, SelectQuery& q) {
+        q.table = msg.value("table", "");
+        if (!is_valid_identifier(q.table)) return false;
+        if (auto it = msg.find("columns"); it != msg.end()) {
+            if (!it->is_array()) return false;
+            for (const auto& c : *it) {
+                if (!c.is_string() || !is_valid_identifier(c.get<std::string>())) return false;
+                q.columns.push_back(c.get<std::string>());
             }
-            else {
-                oss << "'" << v.dump() << "'";
+        }
+        if (auto it = msg.find("where"); it != msg.end()) {
+            if (!it->is_object()) return false;
+            for (auto& [k, v] : it->items()) {
+                if (!is_valid_identifier(k) || v.is_structured()) return false;
+                q.where_columns.push_back(k);
+                q.where_values.push_back(v);
+                q.params.push_back(json_to_db_value(v));
             }
-            first = false;
         }
-        oss << ");";
-        std::string query = oss.str();
-        AppContext::instance().logger->info("[insert handler] SQL: {}", query);
-        session->post_write(R"({"type":"insert_ack","result":"ok"})" "\n");
-        });
+        return true;
+    }
 
+    // 결과 캐시 key: 포맷(응답 본문이 포맷별로 다름) + SQL 모양 + 바인딩 값
+    // where 는 json object 라 컬럼 순서가 항상 정렬돼 있음 → 같은 조건이면 같은 key
+    std::string make_select_cache_key(WireFormat format, const std::string& shape_key,
+        const nlohmann::json& where_values, int64_t limit) {
+        std::string key(1, static_cast<char>('0' + static_cast<int>(format)));
+        key += shape_key;
+        key += '\x1d';
+        key += where_values.dump();
+        key += '#';
+        key += std::to_string(limit);
+        return key;
+    }
+
+    // insert 결과 → insert_ack (세션 포맷으로 인코딩)
+    OutboundRef make_insert_ack(const DbResult& result, WireFormat format, std::optional<int64_t> req_id) {
+        // auto increment 가 없는 테이블의 단건 성공 응답은 항상 같은 내용 → 상수 버퍼 재사용 (json dump 와 같은 키 순서)
+        if (result.ok && result.affected_rows == 1 && result.last_insert_id == 0) {
+            return reply_for(ack_ok_single_row(), format, req_id);
+        }
+        nlohmann::json ack;
+        ack["type"] = "insert_ack";
+        if (req_id) ack[std::string(kRequestIdField)] = *req_id;
+        if (result.ok) {
+            ack["result"] = "ok";
+            ack["affected_rows"] = result.affected_rows;
+            if (result.last_insert_id != 0) {
+                ack["insert_id"] = result.last_insert_id;   // id 를 생성하지 않은 테이블이면 생략
+            }
+        }
+        else {
+            ack["result"] = "fail";
+            ack["msg"] = result.error;
+        }
+        return encode_message(format, ack);
+    }
+}
+
+MessageDispatcher::MessageDispatcher(boost::asio::io_context& io, DataHandler* handler, SessionManager* sessionmanager, const std::string& secret) : handler_(handler), session_manager_(sessionmanager), secret_(secret) {
+    // insert 배칭 단계 (config 로 on/off)
+    auto config = current_config();
+    if (AppContext::instance().db_executor && config->insert_batch_enabled) {
+        insert_batcher_ = std::make_unique<InsertBatcher>(io, AppContext::instance().db_executor,
+            config->insert_batch_max_rows, config->insert_batch_window);
+    }
+
+    ///////////// TCP 메시지 핸들러 등록 /////////////
+    // 기본 type(hello, insert, ...) 은 MessageType switch 로 dispatch 에서 직접 호출 (handle_* 참고)
+    // register_handler 는 빌드 시점에 모르는 type(플러그인 등)용 fallback
 
     //register_handler("insert", [this](std::shared_ptr<Session> session, const nlohmann::json& msg) {
     //    // (1) 필요한 값 추출
@@ -81,38 +201,380 @@ MessageDispatcher::MessageDispatcher(DataHandler* handler, SessionManager* sessi
     //////////////////////////////////////////////////
 }
 
-void MessageDispatcher::dispatch(std::shared_ptr<Session> session, const std::string& packet) {
+MessageDispatcher::~MessageDispatcher() = default;
 
-    // 1. secret 검증
-    if (packet.size() < secret_.size() || packet.compare(0, secret_.size(), secret_) != 0) {
-        AppContext::instance().logger->warn("[SECURITY] 잘못된 secret, session 종료! id={}", session->get_session_id());
-        session->close_session();
-        return;
+void MessageDispatcher::dispatch(std::shared_ptr<Session> session, std::string_view packet) {
+    auto started = std::chrono::steady_clock::now();
+
+    // 1. secret 검증: 핸드셰이크(첫 프레임)에서 한 번만, 상수 시간 비교
+    //    이후 프레임은 비교 없이 그대로 payload (legacy_secret_per_packet 이면 기존처럼 매번)
+    //    secret 생략은 핸드셰이크를 통과한 상태일 때만, 종료된 세션의 프레임은 전부 버림
+    std::string_view payload = packet;   // 수신 버퍼 안의 slice, 복사 없음
+    SessionState state = session->get_state();
+    bool handshake = state == SessionState::Handshaking;
+    bool authenticated = state == SessionState::Handshaked || state == SessionState::LoginWait || state == SessionState::Ready;
+    if (!handshake && !authenticated) {
+        return;   // Closed
+    }
+    if (handshake || current_config()->legacy_secret_per_packet) {
+        if (packet.size() < secret_.size() || !constant_time_equals(packet.substr(0, secret_.size()), secret_)) {
+            LOG_SAMPLED(LogCategory::Dispatch, spdlog::level::warn, "[SECURITY] 잘못된 secret, session 종료! id={}", session->get_session_id());
+            session->close_session();
+            return;
+        }
+        payload = packet.substr(secret_.size());
+        if (handshake) {
+            if (!session->transition_state(SessionState::Handshaking, SessionState::Handshaked)) {
+                return;   // 검사하는 사이 다른 스레드가 세션을 닫음
+            }
+            if (payload.empty()) return;   // secret 만 보낸 핸드셰이크 프레임
+        }
     }
 
-    // 2. secret 뒤의 JSON만 파싱
-    std::string json_str = packet.substr(secret_.size());
-    nlohmann::json msg;
+    // 2. payload 에서 최상위 "type" 만 먼저 확인 (DOM 은 핸들러가 필요할 때 생성)
+    WireFormat format = session->get_wire_format();
+    auto& format_stats = wire_format_stats(format);
+    IncomingMessage msg(format, payload);
+    MessageType message_type = MessageType::Unknown;   // 메트릭용 (플러그인/미등록 type 은 Unknown 으로 합산)
     try {
-        msg = nlohmann::json::parse(json_str);
+        auto type = msg.peek_type();
+        if (!type) {
+            LOG_SAMPLED(LogCategory::Dispatch, spdlog::level::warn, "[SECURITY] {} 형식 오류, session 종료! id={}", wire_format_name(format), session->get_session_id());
+            session->close_session();
+            return;
+        }
+
+        // 3. type별 핸들러 호출: 기본 type 은 perfect hash → switch 로 직접 호출,
+        //    나머지는 등록된 플러그인 핸들러, 그래도 없으면 DOM 없이 (형식 검사만 하고) 바로 거절
+        message_type = lookup_message_type(*type);
+        if (auto* trace = session->current_trace()) {
+            trace->type = message_type;
+            trace->mark(TraceStage::Dispatch);
+            msg.set_trace(trace);   // 여기서부터 만든 DOM 은 Parse 단계로 (peek_type 이 이미 decode 한 포맷은 dispatch 에 포함)
+        }
+        try {
+            switch (message_type) {
+            case MessageType::Hello:
+                handle_hello(session, msg);
+                break;
+            case MessageType::Insert:
+                handle_insert(session, msg);
+                break;
+            case MessageType::Select:
+                handle_select(session, msg);
+                break;
+            case MessageType::SelectStream:
+                handle_select_stream(session, msg);
+                break;
+            default: {
+                auto it = handlers_.find(std::string(*type));
+                if (it != handlers_.end()) {
+                    it->second(session, msg);
+                }
+                else {
+                    session->post_write(reply_for(error_unknown_type(), format, msg.int_field(kRequestIdField)));
+                }
+                break;
+            }
+            }
+        }
+        catch (const nlohmann::json::parse_error&) {
+            throw;   // 핸들러의 json() 에서 처음 드러난 깨진 payload → 아래에서 세션 종료
+        }
+        catch (const nlohmann::json::exception& e) {
+            // 필드 타입 불일치 등 (예: "table" 이 문자열이 아님) → 세션은 유지하고 에러 응답
+            LOG_SAMPLED(LogCategory::Dispatch, spdlog::level::warn, "[dispatch] 핸들러 필드 오류 id={}, type={}, err={}", session->get_session_id(), *type, e.what());
+            session->post_write(reply_for(error_parse_failed(), format, msg.int_field(kRequestIdField)));
+        }
     }
-    catch (const std::exception& e) {
-        AppContext::instance().logger->warn("[SECURITY] JSON 파싱 에러, session 종료! id={}, err={}", session->get_session_id(), e.what());
+    catch (const nlohmann::json::exception& e) {
+        LOG_SAMPLED(LogCategory::Dispatch, spdlog::level::warn, "[SECURITY] {} 파싱 에러, session 종료! id={}, err={}", wire_format_name(format), session->get_session_id(), e.what());
         session->close_session();
         return;
     }
+    format_stats.messages_in.fetch_add(1, std::memory_order_relaxed);
+    format_stats.bytes_in.fetch_add(payload.size(), std::memory_order_relaxed);
+    format_stats.parse_ns.fetch_add(msg.parse_ns(), std::memory_order_relaxed);
+    if (msg.has_dom()) format_stats.dom_parses.fetch_add(1, std::memory_order_relaxed);
+    session->lock_wire_format();   // 첫 프레임 이후에는 hello 불가
+    metrics::observe_dispatch_sync(message_type, std::chrono::steady_clock::now() - started);
+}
+
+// 포맷 협상: {"type":"hello","format":"json"|"msgpack"|"cbor"} (첫 프레임에서만)
+// hello_ack 는 기존 포맷으로 보내고, 그 다음 메시지부터 양방향 새 포맷
+void MessageDispatcher::handle_hello(const std::shared_ptr<Session>& session, IncomingMessage& msg) {
+    auto req_id = msg.int_field(kRequestIdField);
+    if (session->is_wire_format_locked()) {
+        session->post_write(reply_for(error_hello_not_first(), session->get_wire_format(), req_id));
+        return;
+    }
+    auto format = parse_wire_format(msg.string_field("format", "json"));   // DOM 없이 필드만
+    if (!format) {
+        session->post_write(reply_for(error_unsupported_format(), session->get_wire_format(), req_id));
+        return;
+    }
+    nlohmann::json ack;
+    ack["type"] = "hello_ack";
+    ack["format"] = wire_format_name(*format);
+    if (req_id) ack[std::string(kRequestIdField)] = *req_id;
+    session->post_message(ack);
+    session->set_wire_format(*format);
+    LOG_SAMPLED(LogCategory::Dispatch, spdlog::level::info, "[hello] session_id={} format={}", session->get_session_id(), wire_format_name(*format));
+}
+
+// GENERIC insert: 미리 준비한 SQL + params 바인딩
+void MessageDispatcher::handle_insert(const std::shared_ptr<Session>& session, IncomingMessage& in) {
+    const nlohmann::json& msg = in.json();   // 값 바인딩에 전체 필드가 필요
+    LOG_DEBUG("[DEBUG] handler msg: {}", msg.dump());
+    std::string table = msg.value("table", "");
+    nlohmann::json values = msg.value("values", nlohmann::json::object());
+    LOG_DEBUG("[DEBUG] handler values: {}", values.dump());
+    auto req_id = in.int_field(kRequestIdField);
+    WireFormat format = session->get_wire_format();
+
+    // 실제 실행은 DB 워커 풀에서 (io.run 스레드는 MySQL 대기 없이 바로 복귀)
+    auto executor = AppContext::instance().db_executor;
+    if (!executor) {
+        session->post_write(reply_for(ack_db_unavailable(), format, req_id));
+        return;
+    }
+
+    // 값은 bind, 테이블/컬럼명은 식별자 검사 (SQL 인젝션 방지)
+    std::vector<std::string> columns;
+    columns.reserve(values.size());
+    bool valid = is_valid_identifier(table) && values.is_object() && !values.empty();
+    for (auto& [k, v] : values.items()) {
+        LOG_DEBUG("[DEBUG][insert] key={}, type={}", k, v.type_name());
+        if (!is_valid_identifier(k)) valid = false;
+        columns.push_back(k);
+    }
+    if (!valid) {
+        LOG_SAMPLED(LogCategory::Dispatch, spdlog::level::warn, "[insert handler] invalid table/column name, session_id={}", session->get_session_id());
+        session->post_write(reply_for(ack_invalid_identifier(), format, req_id));
+        return;
+    }
+
+    // 완료 콜백: 세션 strand 위에서 실행됨
+    // 요청 trace 는 여기서 떼어 가서 DB 시작/끝을 채운 뒤 응답과 함께 넘김
+    RequestTrace trace = session->take_trace();
+    auto on_done = [session, table, trace, format, req_id](const DbResult& result) mutable {
+        if (session->is_closed()) return;
+        if (!result.ok) {
+            LOG_SAMPLED(LogCategory::Db, spdlog::level::err, "[insert handler] DB error: table={}, err={}", table, result.error);
+        }
+        if (trace && result.started != std::chrono::steady_clock::time_point{}) {   // 커넥션 획득 실패면 비어 있음
+            trace.set(TraceStage::DbStart, result.started);
+            trace.set(TraceStage::DbEnd, result.finished);
+        }
+        session->post_write(make_insert_ack(result, format, req_id), trace);
+    };
+
+    // 배칭 사용 시: 같은 테이블/컬럼 집합끼리 multi-row INSERT 로 묶어서 실행
+    if (insert_batcher_) {
+        insert_batcher_->add(table, std::move(values), session->get_strand(), std::move(on_done));
+        return;
+    }
 
-    // 3. type별 핸들러 호출
-    std::string type = msg.value("type", "");
-    auto it = handlers_.find(type);
-    if (it != handlers_.end()) {
-        it->second(session, msg);
+    std::vector<mysqlx::Value> params;
+    params.reserve(values.size());
+    for (auto& [k, v] : values.items()) {
+        params.push_back(json_to_db_value(v));
     }
-    else {
-        session->post_write(R"({"type":"error","msg":"Unknown message type."})" "\n");
+    std::string shape_key = make_shape_key("insert", table, columns);
+
+    bool queued = executor->submit(
+        [table, columns = std::move(columns), shape_key, params = std::move(params)](DbConnection& conn) {
+            auto res = conn.execute(shape_key,
+                [&]() { return build_insert_shape(table, columns, 1); },
+                params);
+            invalidate_cached_table(table);
+            DbResult result;
+            result.ok = true;
+            result.affected_rows = res.getAffectedItemsCount();
+            result.last_insert_id = res.getAutoIncrementValue();
+            return result;
+        },
+        session->get_strand(),
+        std::move(on_done));
+
+    if (!queued) {
+        LOG_SAMPLED(LogCategory::Db, spdlog::level::warn, "[insert handler] DB queue full! session_id={}", session->get_session_id());
+        session->post_write(reply_for(ack_busy(), format, req_id), trace);   // busy 응답도 요청 trace 와 함께 (단계별 히스토그램에 포함)
+    }
+}
+
+// 조회: {"type":"select","table":"t","columns":["a","b"],"where":{"id":1},"limit":10,"cache_ttl_ms":1000}
+// - columns 생략 시 *, where 는 컬럼 = 값 AND 조건 (NULL 도 일치), limit 는 select_max_rows 로 잘림
+// - 응답: {"type":"select_result","result":"ok","columns":[...],"rows":[[...],...]}
+// - 같은 포맷/쿼리/값이면 QueryCache 에서 DB 왕복 없이 응답 (cache_ttl_ms 가 0 이면 캐시 안 씀)
+// - 응답 1개가 max_outbound_packet_size 를 넘으면 fail (큰 결과는 select_stream 으로)
+void MessageDispatcher::handle_select(const std::shared_ptr<Session>& session, IncomingMessage& in) {
+    const nlohmann::json& msg = in.json();
+    auto config = current_config();
+    auto req_id = in.int_field(kRequestIdField);
+    WireFormat format = session->get_wire_format();
+    SelectQuery query;
+    if (!parse_select_query(msg, query)) {
+        LOG_SAMPLED(LogCategory::Dispatch, spdlog::level::warn, "[select handler] invalid table/column/where, session_id={}", session->get_session_id());
+        session->post_write(reply_for(select_invalid_request(), format, req_id));
+        return;
+    }
+
+    auto max_rows = static_cast<int64_t>(config->select_max_rows);
+    int64_t limit = max_rows;
+    if (auto it = msg.find("limit"); it != msg.end() && it->is_number_integer()) {
+        limit = std::clamp<int64_t>(it->get<int64_t>(), 1, max_rows);
+    }
+    query.params.push_back(mysqlx::Value(limit));
+
+    // TTL 은 설정값이 상한 (요청은 더 짧게만)
+    auto ttl = config->query_cache_ttl;
+    if (auto it = msg.find("cache_ttl_ms"); it != msg.end() && it->is_number_integer()) {
+        ttl = std::min(ttl, std::chrono::milliseconds(std::max<int64_t>(0, it->get<int64_t>())));
+    }
+    std::shared_ptr<QueryCache> cache = ttl.count() > 0 ? AppContext::instance().query_cache : nullptr;
+
+    std::string shape_key = make_select_shape_key(query.table, query.columns, query.where_columns);
+    std::string cache_key;
+    if (cache) {
+        cache_key = make_select_cache_key(format, shape_key, query.where_values, limit);
+        if (auto body = cache->find(cache_key)) {
+            // 인코딩된 본문 그대로 (DB/직렬화 없음, 캐시 본문에는 req_id 가 없으므로 있으면 끼워 넣은 사본)
+            session->post_write(req_id ? encode_with_request_id(format, *body, *req_id) : OutboundRef::make(*body));
+            return;
+        }
+    }
+
+    auto executor = AppContext::instance().db_executor;
+    if (!executor) {
+        session->post_write(reply_for(select_db_unavailable(), format, req_id));
+        return;
+    }
+    // 실행 전에 읽어 둠: 실행 중에 이 테이블 write 가 끝나면 결과를 캐시에 넣지 않음
+    uint64_t generation = cache ? cache->table_generation(query.table) : 0;
+
+    // 완료 콜백: 세션 strand 위에서 실행됨 (응답 본문은 워커에서 이미 인코딩)
+    RequestTrace trace = session->take_trace();
+    auto on_done = [session, table = query.table, trace, format, req_id](const DbResult& result) mutable {
+        if (session->is_closed()) return;
+        if (trace && result.started != std::chrono::steady_clock::time_point{}) {
+            trace.set(TraceStage::DbStart, result.started);
+            trace.set(TraceStage::DbEnd, result.finished);
+        }
+        if (!result.ok || !result.body) {
+            LOG_SAMPLED(LogCategory::Db, spdlog::level::err, "[select handler] DB error: table={}, err={}", table, result.error);
+            nlohmann::json fail;
+            fail["type"] = "select_result";
+            fail["result"] = "fail";
+            fail["msg"] = result.error;
+            if (req_id) fail[std::string(kRequestIdField)] = *req_id;
+            session->post_write(encode_message(format, fail), trace);
+            return;
+        }
+        session->post_write(req_id ? encode_with_request_id(format, *result.body, *req_id) : OutboundRef::make(*result.body), trace);
+    };
+
+    bool queued = executor->submit(
+        [query = std::move(query), shape_key, format, max_bytes = config->max_outbound_packet_size,
+        cache, cache_key = std::move(cache_key), generation, ttl](DbConnection& conn) {
+            auto res = conn.execute(shape_key,
+                [&]() { return build_select_shape(query.table, query.columns, query.where_columns); },
+                query.params);
+
+            nlohmann::json reply;
+            reply["type"] = "select_result";
+            reply["result"] = "ok";
+            reply["columns"] = result_column_names(res);
+            nlohmann::json rows = nlohmann::json::array();
+            while (mysqlx::Row row = res.fetchOne()) {
+                rows.push_back(row_to_json(row));
+            }
+
+            DbResult result;
+            result.affected_rows = rows.size();
+            reply["rows"] = std::move(rows);
+            std::string body = encode_body(format, reply);
+            if (body.size() > max_bytes) {
+                // select_max_rows 만으로는 행이 넓을 때 크기가 안 묶임 → 클라이언트가 받을 수 없는 프레임은 보내지 않음
+                result.error = fmt::format("result too large ({} bytes > max_outbound_packet_size {}), use select_stream",
+                    body.size(), max_bytes);
+                return result;
+            }
+            result.ok = true;
+            result.body = std::make_shared<const std::string>(std::move(body));
+            if (cache) {
+                cache->insert(cache_key, query.table, generation, result.body, ttl);
+            }
+            return result;
+        },
+        session->get_strand(),
+        std::move(on_done));
+
+    if (!queued) {
+        LOG_SAMPLED(LogCategory::Db, spdlog::level::warn, "[select handler] DB queue full! session_id={}", session->get_session_id());
+        session->post_write(reply_for(select_busy(), format, req_id), trace);
+    }
+}
+
+// 스트리밍 조회: {"type":"select_stream","stream_id":7,"table":"t","columns":[...],"where":{...},"limit":N}
+// - 응답: rows_chunk {"stream_id","seq","columns"(seq 0 만),"rows"} 여러 개 → rows_end {"stream_id","result","rows","chunks"}
+// - DB 워커가 행을 하나씩 읽어 stream_chunk_rows / stream_chunk_bytes 단위로 인코딩해서 바로 post
+//   세션 송신 대기가 stream_high_water 이상이면 워커를 놓고 write 완료 때 이어감 (SelectStream) → 세션당 메모리 = high water × 청크 크기
+// - 결과 캐시는 쓰지 않음, limit 생략 시 전체 (select_max_rows 적용 안 함)
+void MessageDispatcher::handle_select_stream(const std::shared_ptr<Session>& session, IncomingMessage& in) {
+    const nlohmann::json& msg = in.json();
+    auto req_id = in.int_field(kRequestIdField);
+    WireFormat format = session->get_wire_format();
+    SelectQuery query;
+    if (!parse_select_query(msg, query)) {
+        LOG_SAMPLED(LogCategory::Dispatch, spdlog::level::warn, "[select_stream] invalid table/column/where, session_id={}", session->get_session_id());
+        session->post_write(reply_for(stream_invalid_request(), format, req_id));
+        return;
+    }
+    SelectStreamRequest request;
+    request.request_id = req_id;
+    if (auto it = msg.find("stream_id"); it != msg.end() && it->is_number_integer()) {
+        request.stream_id = it->get<int64_t>();
+    }
+    int64_t limit = std::numeric_limits<int64_t>::max();
+    if (auto it = msg.find("limit"); it != msg.end() && it->is_number_integer()) {
+        limit = std::max<int64_t>(1, it->get<int64_t>());
+    }
+    request.table = std::move(query.table);
+    request.columns = std::move(query.columns);
+    request.where_columns = std::move(query.where_columns);
+    request.params = std::move(query.params);
+    request.params.push_back(mysqlx::Value(limit));
+
+    auto executor = AppContext::instance().db_executor;
+    if (!executor) {
+        session->post_write(reply_for(stream_db_unavailable(), format, req_id));
+        return;
+    }
+
+    // 스트림은 끝날 때까지 커넥션을 잡고 있으므로 동시 개수 제한 (insert/select 가 굶지 않게)
+    auto config = current_config();
+    SelectStream::Limits limits;
+    limits.chunk_rows = config->stream_chunk_rows;
+    limits.chunk_bytes = config->stream_chunk_bytes;
+    limits.max_packet_bytes = config->max_outbound_packet_size;
+    limits.high_water = config->stream_high_water;
+    limits.stall_timeout = config->stream_stall_timeout;
+    limits.max_concurrent = config->stream_max_concurrent;
+
+    RequestTrace trace = session->take_trace();
+    auto started = SelectStream::start(executor, session, std::move(request), limits, trace);
+    if (started == SelectStream::StartResult::QueueFull) {
+        LOG_SAMPLED(LogCategory::Db, spdlog::level::warn, "[select_stream] DB queue full! session_id={}", session->get_session_id());
+    }
+    if (started != SelectStream::StartResult::Started) {
+        session->post_write(reply_for(stream_busy(), format, req_id), trace);
     }
 }
 
 void MessageDispatcher::register_handler(const std::string& type, HandlerFunc handler) {
+    if (lookup_message_type(type) != MessageType::Unknown) {
+        AppContext::instance().logger->warn("[MessageDispatcher] '{}' 는 기본 type 이라 등록된 핸들러는 호출되지 않음", type);
+    }
     handlers_[type] = handler;
 }
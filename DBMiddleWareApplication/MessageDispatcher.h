@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <functional>
+#include <string_view>
 #include <unordered_map>
 #include <memory>
 #include <nlohmann/json.hpp>
@@ -8,23 +9,35 @@
 class Session;
 class DataHandler;
 class SessionManager; // 전방 선언
+class InsertBatcher;
+class IncomingMessage;
 
 class MessageDispatcher {
 public:
-    using HandlerFunc = std::function<void(std::shared_ptr<Session>, const nlohmann::json&)>;
+    using HandlerFunc = std::function<void(std::shared_ptr<Session>, IncomingMessage&)>;   // DOM 은 IncomingMessage::json() 으로 필요할 때만
     using UdpHandlerFunc = std::function<void(std::shared_ptr<Session>, const nlohmann::json&, const boost::asio::ip::udp::endpoint&, boost::asio::ip::udp::socket&)>;
 
-    MessageDispatcher(DataHandler* handler, SessionManager* sessionmanager, const std::string& secret); // DataHandler 포인터 주입
+    MessageDispatcher(boost::asio::io_context& io, DataHandler* handler, SessionManager* sessionmanager, const std::string& secret); // DataHandler 포인터 주입
 
-    void dispatch(std::shared_ptr<Session> session, const std::string& packet);
+    void dispatch(std::shared_ptr<Session> session, std::string_view packet);
     //void dispatch(std::shared_ptr<Session> session, const nlohmann::json& msg);
 
+    ~MessageDispatcher();
+
+    // 런타임 등록 (플러그인용 fallback, MessageType 에 있는 기본 type 은 switch 가 우선)
     void register_handler(const std::string& type, HandlerFunc handler);
 
 private:
-    std::unordered_map<std::string, HandlerFunc> handlers_;
+    // 기본 type 핸들러 (dispatch 의 switch 에서 직접 호출)
+    void handle_hello(const std::shared_ptr<Session>& session, IncomingMessage& msg);
+    void handle_insert(const std::shared_ptr<Session>& session, IncomingMessage& in);
+    void handle_select(const std::shared_ptr<Session>& session, IncomingMessage& in);
+    void handle_select_stream(const std::shared_ptr<Session>& session, IncomingMessage& in);
+
+    std::unordered_map<std::string, HandlerFunc> handlers_;   // 플러그인 type (기본 type 이 아닐 때만 조회)
     DataHandler* handler_;
     SessionManager* session_manager_;
     std::string secret_;  // 시크릿 값 저장
+    std::unique_ptr<InsertBatcher> insert_batcher_;   // insert multi-row 배칭 (비활성 시 nullptr)
 };
 
@@ -0,0 +1,95 @@
+﻿#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// 빌드 시점에 고정된 메시지 type 목록
+// - 문자열 → enum 변환은 컴파일 타임에 만든 perfect hash 테이블 (충돌 없음을 static_assert 로 보장)
+// - 새 type 추가: enum 에 항목 + kMessageTypeNames 에 같은 순서로 이름 추가
+//   (MessageDispatcher::dispatch 의 switch 에 핸들러 연결)
+enum class MessageType : uint8_t {
+    Unknown = 0,
+    Hello,
+    Insert,
+    Select,
+    SelectStream,
+    Count
+};
+
+inline constexpr std::array<std::string_view, static_cast<size_t>(MessageType::Count)> kMessageTypeNames{
+    "",        // Unknown
+    "hello",
+    "insert",
+    "select",
+    "select_stream",
+};
+
+constexpr std::string_view message_type_name(MessageType type) {
+    return kMessageTypeNames[static_cast<size_t>(type)];
+}
+
+namespace message_type_detail {
+    constexpr size_t kTableSize = 16;   // 2의 거듭제곱, type 수보다 충분히 크게
+    static_assert((kTableSize & (kTableSize - 1)) == 0);
+    static_assert(kTableSize >= static_cast<size_t>(MessageType::Count));
+
+    // seed 를 섞은 FNV-1a
+    constexpr uint32_t hash(std::string_view s, uint32_t seed) {
+        uint32_t h = 2166136261u ^ seed;
+        for (char c : s) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    // 모든 이름이 서로 다른 slot 에 들어가는 seed 를 컴파일 타임에 탐색
+    constexpr uint32_t find_seed() {
+        for (uint32_t seed = 0; seed < 100000; ++seed) {
+            std::array<bool, kTableSize> used{};
+            bool ok = true;
+            for (size_t i = 1; i < kMessageTypeNames.size() && ok; ++i) {
+                size_t slot = hash(kMessageTypeNames[i], seed) & (kTableSize - 1);
+                if (used[slot]) ok = false;
+                used[slot] = true;
+            }
+            if (ok) return seed;
+        }
+        return UINT32_MAX;
+    }
+
+    inline constexpr uint32_t kSeed = find_seed();
+    static_assert(kSeed != UINT32_MAX, "MessageType perfect hash: seed 를 찾지 못함 (kTableSize 를 늘릴 것)");
+
+    constexpr std::array<MessageType, kTableSize> build_table() {
+        std::array<MessageType, kTableSize> table{};   // 빈 slot = Unknown
+        for (size_t i = 1; i < kMessageTypeNames.size(); ++i) {
+            table[hash(kMessageTypeNames[i], kSeed) & (kTableSize - 1)] = static_cast<MessageType>(i);
+        }
+        return table;
+    }
+
+    inline constexpr std::array<MessageType, kTableSize> kTable = build_table();
+}
+
+// type 문자열 → MessageType (해시 1번 + 문자열 비교 1번, 할당 없음)
+constexpr MessageType lookup_message_type(std::string_view name) {
+    using namespace message_type_detail;
+    MessageType candidate = kTable[hash(name, kSeed) & (kTableSize - 1)];
+    return message_type_name(candidate) == name ? candidate : MessageType::Unknown;
+}
+
+namespace message_type_detail {
+    constexpr bool all_names_round_trip() {
+        for (size_t i = 1; i < kMessageTypeNames.size(); ++i) {
+            if (lookup_message_type(kMessageTypeNames[i]) != static_cast<MessageType>(i)) return false;
+        }
+        return true;
+    }
+}
+static_assert(message_type_detail::all_names_round_trip(), "kMessageTypeNames 와 MessageType 순서가 맞지 않음");
+static_assert(lookup_message_type("hello") == MessageType::Hello);
+static_assert(lookup_message_type("insert") == MessageType::Insert);
+static_assert(lookup_message_type("") == MessageType::Unknown);
+static_assert(lookup_message_type("inserts") == MessageType::Unknown);
@@ -0,0 +1,232 @@
+﻿#include "Metrics.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <spdlog/fmt/fmt.h>
+#include "AppContext.h"
+#include "MysqlPool.h"
+#include "QueryCache.h"
+
+namespace metrics {
+
+namespace {
+    constexpr size_t kCounterCount = static_cast<size_t>(Counter::Count);
+    constexpr size_t kHistogramCount = static_cast<size_t>(Histogram::Count);
+    constexpr size_t kTypeCount = static_cast<size_t>(MessageType::Count);
+
+    struct HistogramSlot {
+        std::array<std::atomic<uint64_t>, buckets::kCount> counts{};
+        std::atomic<uint64_t> sum{ 0 };
+    };
+
+    // 스레드 1개 전용 (쓰는 쪽은 소유 스레드뿐 → fetch_add 대신 load + store)
+    struct ThreadSlot {
+        std::array<std::atomic<uint64_t>, kCounterCount> counters{};
+        std::array<HistogramSlot, kHistogramCount> histograms{};
+        std::array<HistogramSlot, kTypeCount> dispatch{};
+        std::array<HistogramSlot, kTraceStageCount> stages{};
+    };
+
+    std::mutex g_slots_mutex;                              // 스레드 첫 기록 / 수집 때만
+    std::vector<std::unique_ptr<ThreadSlot>> g_slots;
+
+    ThreadSlot* register_slot() {
+        auto slot = std::make_unique<ThreadSlot>();
+        ThreadSlot* raw = slot.get();
+        std::lock_guard<std::mutex> lock(g_slots_mutex);
+        g_slots.push_back(std::move(slot));
+        return raw;
+    }
+
+    ThreadSlot& local_slot() {
+        thread_local ThreadSlot* slot = register_slot();
+        return *slot;
+    }
+
+    inline void bump(std::atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    inline void record(HistogramSlot& histogram, uint64_t value) {
+        bump(histogram.counts[buckets::index_of(value)], 1);
+        bump(histogram.sum, value);
+    }
+
+    struct HistogramTotal {
+        std::array<uint64_t, buckets::kCount> counts{};
+        uint64_t sum = 0;
+    };
+
+    void accumulate(HistogramTotal& total, const HistogramSlot& slot) {
+        for (size_t i = 0; i < buckets::kCount; ++i) {
+            total.counts[i] += slot.counts[i].load(std::memory_order_relaxed);
+        }
+        total.sum += slot.sum.load(std::memory_order_relaxed);
+    }
+
+    // scale: 기록 단위 → 노출 단위 (ns → seconds 면 1e-9)
+    // 비어 있는 꼬리 버킷은 생략하고 +Inf 로 닫음. 마지막 버킷은 상한이 없는 overflow 라 +Inf 에만 들어감
+    void write_histogram(std::string& out, const char* name, const std::string& labels,
+        const HistogramTotal& total, double scale) {
+        size_t last = 0;
+        for (size_t i = 0; i + 1 < buckets::kCount; ++i) {
+            if (total.counts[i]) last = i;
+        }
+        std::string sep = labels.empty() ? "" : ",";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i <= last; ++i) {
+            cumulative += total.counts[i];
+            fmt::format_to(std::back_inserter(out), "{}_bucket{{{}{}le=\"{}\"}} {}\n",
+                name, labels, sep, static_cast<double>(buckets::upper_of(i)) * scale, cumulative);
+        }
+        for (size_t i = last + 1; i < buckets::kCount; ++i) cumulative += total.counts[i];
+        fmt::format_to(std::back_inserter(out), "{}_bucket{{{}{}le=\"+Inf\"}} {}\n", name, labels, sep, cumulative);
+        std::string braces = labels.empty() ? "" : "{" + labels + "}";
+        fmt::format_to(std::back_inserter(out), "{}_sum{} {}\n", name, braces, static_cast<double>(total.sum) * scale);
+        fmt::format_to(std::back_inserter(out), "{}_count{} {}\n", name, braces, cumulative);
+    }
+
+    void write_header(std::string& out, const char* name, const char* type, const char* help) {
+        fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+    }
+}
+
+void add(Counter counter, uint64_t n) {
+    bump(local_slot().counters[static_cast<size_t>(counter)], n);
+}
+
+void observe(Histogram histogram, uint64_t value) {
+    record(local_slot().histograms[static_cast<size_t>(histogram)], value);
+}
+
+void observe_dispatch_sync(MessageType type, std::chrono::nanoseconds elapsed) {
+    record(local_slot().dispatch[static_cast<size_t>(type)], static_cast<uint64_t>(elapsed.count()));
+}
+
+void observe_stage(TraceStage stage, std::chrono::nanoseconds elapsed) {
+    record(local_slot().stages[static_cast<size_t>(stage)], static_cast<uint64_t>(std::max<int64_t>(0, elapsed.count())));
+}
+
+std::string render_prometheus() {
+    // 1. 스레드 슬롯 합산
+    std::array<uint64_t, kCounterCount> counters{};
+    std::array<HistogramTotal, kHistogramCount> histograms{};
+    std::array<HistogramTotal, kTypeCount> dispatch{};
+    std::array<HistogramTotal, kTraceStageCount> stages{};
+    {
+        std::lock_guard<std::mutex> lock(g_slots_mutex);
+        for (const auto& slot : g_slots) {
+            for (size_t i = 0; i < kCounterCount; ++i) {
+                counters[i] += slot->counters[i].load(std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < kHistogramCount; ++i) accumulate(histograms[i], slot->histograms[i]);
+            for (size_t i = 0; i < kTypeCount; ++i) accumulate(dispatch[i], slot->dispatch[i]);
+            for (size_t i = 0; i < kTraceStageCount; ++i) accumulate(stages[i], slot->stages[i]);
+        }
+    }
+    auto counter = [&](Counter c) { return counters[static_cast<size_t>(c)]; };
+
+    std::string out;
+    out.reserve(16384);
+
+    // 2. 연결 수명
+    write_header(out, "dbmw_connections_accepted_total", "counter", "Accepted TCP connections.");
+    fmt::format_to(std::back_inserter(out), "dbmw_connections_accepted_total {}\n", counter(Counter::Accepts));
+    write_header(out, "dbmw_connections_rejected_total", "counter", "Connections closed by the IP allow list.");
+    fmt::format_to(std::back_inserter(out), "dbmw_connections_rejected_total {}\n", counter(Counter::AcceptRejected));
+    write_header(out, "dbmw_sessions_closed_total", "counter", "Closed sessions.");
+    fmt::format_to(std::back_inserter(out), "dbmw_sessions_closed_total {}\n", counter(Counter::SessionsClosed));
+    uint64_t opened = counter(Counter::Accepts) - counter(Counter::AcceptRejected);
+    uint64_t closed = counter(Counter::SessionsClosed);
+    write_header(out, "dbmw_sessions_active", "gauge", "Sessions accepted and not yet closed.");
+    fmt::format_to(std::back_inserter(out), "dbmw_sessions_active {}\n", opened > closed ? opened - closed : 0);
+
+    // 3. message type 별 dispatch 동기 구간 (_count 의 rate = 요청률, 요청 전체 시간은 4 의 request_* 참고)
+    write_header(out, "dbmw_dispatch_sync_seconds", "histogram",
+        "Network-thread time in MessageDispatcher::dispatch per message type (parse and synchronous handler work; excludes DB execution and reply write).");
+    for (size_t i = 0; i < kTypeCount; ++i) {
+        auto name = message_type_name(static_cast<MessageType>(i));
+        std::string labels = fmt::format("type=\"{}\"", name.empty() ? std::string_view("other") : name);
+        write_histogram(out, "dbmw_dispatch_sync_seconds", labels, dispatch[i], 1e-9);
+    }
+
+    // 4. 요청 단계별 시간 (수신 → 응답 write 완료, RequestTrace)
+    write_header(out, "dbmw_request_duration_seconds", "histogram", "Time from read completion to the last traced stage (usually reply written).");
+    write_histogram(out, "dbmw_request_duration_seconds", "", stages[static_cast<size_t>(TraceStage::Read)], 1e-9);
+    write_header(out, "dbmw_request_stage_seconds", "histogram", "Time spent reaching each request stage from the previous traced stage.");
+    for (size_t i = static_cast<size_t>(TraceStage::Read) + 1; i < kTraceStageCount; ++i) {
+        std::string labels = fmt::format("stage=\"{}\"", trace_stage_name(static_cast<TraceStage>(i)));
+        write_histogram(out, "dbmw_request_stage_seconds", labels, stages[i], 1e-9);
+    }
+    write_header(out, "dbmw_slow_requests_total", "counter", "Requests over trace_slow_threshold_ms (sampled into /debug/slow_requests).");
+    fmt::format_to(std::back_inserter(out), "dbmw_slow_requests_total {}\n", counter(Counter::SlowRequests));
+
+    // 스트리밍 (select_stream)
+    write_header(out, "dbmw_stream_chunks_total", "counter", "rows_chunk frames sent by select_stream.");
+    fmt::format_to(std::back_inserter(out), "dbmw_stream_chunks_total {}\n", counter(Counter::StreamChunks));
+    write_header(out, "dbmw_stream_backpressure_waits_total", "counter", "Times a stream producer paused on the session write queue high-water mark.");
+    fmt::format_to(std::back_inserter(out), "dbmw_stream_backpressure_waits_total {}\n", counter(Counter::StreamBackpressureWaits));
+    write_header(out, "dbmw_stream_aborts_total", "counter", "Streams ended early (session closed, stall timeout or DB error).");
+    fmt::format_to(std::back_inserter(out), "dbmw_stream_aborts_total {}\n", counter(Counter::StreamAborts));
+    write_header(out, "dbmw_stream_chunk_splits_total", "counter", "rows_chunk frames split because the encoded size exceeded max_outbound_packet_size.");
+    fmt::format_to(std::back_inserter(out), "dbmw_stream_chunk_splits_total {}\n", counter(Counter::StreamChunkSplits));
+
+    // 5. 송신 큐
+    write_header(out, "dbmw_write_queue_depth", "histogram", "Session write queue length at enqueue.");
+    write_histogram(out, "dbmw_write_queue_depth", "", histograms[static_cast<size_t>(Histogram::WriteQueueDepth)], 1.0);
+    write_header(out, "dbmw_write_queue_overflow_streak", "histogram", "Consecutive full-queue enqueues, observed at each overflow.");
+    write_histogram(out, "dbmw_write_queue_overflow_streak", "", histograms[static_cast<size_t>(Histogram::WriteQueueOverflowStreak)], 1.0);
+    write_header(out, "dbmw_write_queue_dropped_total", "counter", "Messages dropped because the write queue was full.");
+    fmt::format_to(std::back_inserter(out), "dbmw_write_queue_dropped_total {}\n", counter(Counter::WriteQueueDrops));
+    write_header(out, "dbmw_write_queue_overflow_closes_total", "counter", "Sessions closed after repeated write queue overflow.");
+    fmt::format_to(std::back_inserter(out), "dbmw_write_queue_overflow_closes_total {}\n", counter(Counter::WriteQueueOverflowCloses));
+
+    // 6. select 결과 캐시
+    if (auto cache = AppContext::instance().query_cache) {
+        auto st = cache->stats();
+        write_header(out, "dbmw_query_cache_lookups_total", "counter", "QueryCache lookups by result.");
+        fmt::format_to(std::back_inserter(out), "dbmw_query_cache_lookups_total{{result=\"hit\"}} {}\n", st.hits);
+        fmt::format_to(std::back_inserter(out), "dbmw_query_cache_lookups_total{{result=\"miss\"}} {}\n", st.misses);
+        write_header(out, "dbmw_query_cache_stale_total", "counter", "Expired or invalidated entries dropped on access or eviction.");
+        fmt::format_to(std::back_inserter(out), "dbmw_query_cache_stale_total {}\n", st.stale);
+        write_header(out, "dbmw_query_cache_evictions_total", "counter", "Live entries evicted by the memory bound.");
+        fmt::format_to(std::back_inserter(out), "dbmw_query_cache_evictions_total {}\n", st.evictions);
+        write_header(out, "dbmw_query_cache_invalidations_total", "counter", "Table invalidations after writes.");
+        fmt::format_to(std::back_inserter(out), "dbmw_query_cache_invalidations_total {}\n", st.invalidations);
+        write_header(out, "dbmw_query_cache_entries", "gauge", "Cached results.");
+        fmt::format_to(std::back_inserter(out), "dbmw_query_cache_entries {}\n", st.entries);
+        write_header(out, "dbmw_query_cache_bytes", "gauge", "Approximate cache memory use.");
+        fmt::format_to(std::back_inserter(out), "dbmw_query_cache_bytes {}\n", st.bytes);
+        write_header(out, "dbmw_query_cache_max_bytes", "gauge", "Cache memory bound.");
+        fmt::format_to(std::back_inserter(out), "dbmw_query_cache_max_bytes {}\n", st.max_bytes);
+    }
+
+    // 7. DB 풀 (풀이 이미 모으는 값을 그대로 노출)
+    if (auto db = AppContext::instance().db) {
+        auto st = db->stats();
+        write_header(out, "dbmw_db_pool_connections", "gauge", "MySQL pool connections by state.");
+        fmt::format_to(std::back_inserter(out), "dbmw_db_pool_connections{{state=\"open\"}} {}\n", st.open);
+        fmt::format_to(std::back_inserter(out), "dbmw_db_pool_connections{{state=\"in_use\"}} {}\n", st.in_use);
+        fmt::format_to(std::back_inserter(out), "dbmw_db_pool_connections{{state=\"idle\"}} {}\n", st.idle);
+        write_header(out, "dbmw_db_pool_waiters", "gauge", "Threads waiting in MySqlPool::acquire.");
+        fmt::format_to(std::back_inserter(out), "dbmw_db_pool_waiters {}\n", st.waiters);
+        write_header(out, "dbmw_db_acquire_timeouts_total", "counter", "MySqlPool::acquire timeouts.");
+        fmt::format_to(std::back_inserter(out), "dbmw_db_acquire_timeouts_total {}\n", st.timeouts);
+
+        write_header(out, "dbmw_db_acquire_wait_seconds", "histogram", "MySqlPool::acquire wait time.");
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < MySqlPoolStats::kWaitBoundsUs.size(); ++i) {
+            cumulative += st.wait_buckets[i];
+            fmt::format_to(std::back_inserter(out), "dbmw_db_acquire_wait_seconds_bucket{{le=\"{}\"}} {}\n",
+                static_cast<double>(MySqlPoolStats::kWaitBoundsUs[i]) * 1e-6, cumulative);
+        }
+        cumulative += st.wait_buckets.back();
+        fmt::format_to(std::back_inserter(out), "dbmw_db_acquire_wait_seconds_bucket{{le=\"+Inf\"}} {}\n", cumulative);
+        fmt::format_to(std::back_inserter(out), "dbmw_db_acquire_wait_seconds_sum {}\n", static_cast<double>(st.wait_sum_us) * 1e-6);
+        fmt::format_to(std::back_inserter(out), "dbmw_db_acquire_wait_seconds_count {}\n", cumulative);
+    }
+    return out;
+}
+
+}
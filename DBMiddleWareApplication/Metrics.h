@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "MessageType.h"
+#include "RequestTrace.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// 프로세스 내장 메트릭 (MetricsServer 가 /metrics 에 Prometheus text format 으로 노출)
+// - 기록: 스레드마다 자기 슬롯에만 씀 (thread_local, 락/RMW 없음 → relaxed load + store)
+// - 수집: /metrics 요청 시 모든 스레드 슬롯을 relaxed load 로 합산 (수 ms 늦은 값 허용)
+// - 스레드 슬롯은 등록 후 해제하지 않음 (io/DB 워커 스레드는 프로세스 수명과 같음)
+namespace metrics {
+
+enum class Counter {
+    Accepts,                    // accept 된 TCP 연결
+    AcceptRejected,             // IP 화이트리스트로 바로 닫은 연결
+    SessionsClosed,             // close_session 완료 (중복 호출 제외)
+    WriteQueueDrops,            // write_queue FULL 로 버린 메시지
+    WriteQueueOverflowCloses,   // FULL 이 연속돼서 종료한 세션
+    SlowRequests,               // trace_slow_threshold 를 넘어 slow ring buffer 에 들어간 요청
+    StreamChunks,               // select_stream 이 보낸 rows_chunk
+    StreamBackpressureWaits,    // 송신 대기가 high water 이상이라 생산자가 멈춘 횟수
+    StreamAborts,               // 세션 종료 / stall timeout / DB 오류로 중단된 스트림
+    StreamChunkSplits,          // 인코딩 크기가 max_outbound_packet_size 를 넘어 반으로 나눈 청크
+    Count
+};
+
+enum class Histogram {
+    WriteQueueDepth,            // enqueue 시점의 write_queue 길이
+    WriteQueueOverflowStreak,   // FULL 이 날 때마다 그때까지의 연속 FULL 횟수
+    Count
+};
+
+// HDR 방식 로그-선형 버킷: 2의 거듭제곱 구간마다 4칸 (상대 오차 25% 이내)
+// 0~3 은 그대로, 2^40 이상은 마지막 버킷 (상한 없음 → 노출 때 +Inf 로만)
+namespace buckets {
+    constexpr int kSubBits = 2;
+    constexpr size_t kSub = size_t(1) << kSubBits;
+    constexpr int kMaxExp = 40;
+    constexpr size_t kCount = (kMaxExp - kSubBits) * kSub + kSub;
+
+    inline int msb(uint64_t v) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+
+    inline size_t index_of(uint64_t v) {
+        if (v < kSub) return static_cast<size_t>(v);
+        int m = msb(v);
+        if (m >= kMaxExp) return kCount - 1;
+        size_t sub = static_cast<size_t>(v >> (m - kSubBits)) & (kSub - 1);
+        return static_cast<size_t>(m - kSubBits + 1) * kSub + sub;
+    }
+
+    // 버킷에 들어가는 최대값 (정수 값 기준, Prometheus le 용)
+    inline uint64_t upper_of(size_t index) {
+        if (index < kSub) return index;
+        int m = static_cast<int>(index / kSub) + kSubBits - 1;
+        uint64_t sub = index % kSub;
+        uint64_t width = uint64_t(1) << (m - kSubBits);
+        return ((kSub + sub) << (m - kSubBits)) + width - 1;
+    }
+}
+
+void add(Counter counter, uint64_t n = 1);
+void observe(Histogram histogram, uint64_t value);
+// type 별 요청 수 + 네트워크 스레드가 dispatch 안에서 쓴 시간 (파싱 + 핸들러 동기 부분, DB 작업/응답 송신 대기는 제외)
+void observe_dispatch_sync(MessageType type, std::chrono::nanoseconds elapsed);
+void observe_stage(TraceStage stage, std::chrono::nanoseconds elapsed);      // 요청 단계별 구간 시간 (tracing::finish)
+
+// 전체 스레드 합산 → Prometheus text exposition format
+std::string render_prometheus();
+
+}
@@ -0,0 +1,133 @@
+﻿#include "MetricsServer.h"
+#include "AppContext.h"
+#include "Metrics.h"
+
+using boost::asio::ip::tcp;
+
+namespace {
+    constexpr size_t kMaxRequestHeaderBytes = 8192;
+
+    std::string http_response(const char* status, const std::string& content_type, const std::string& body) {
+        std::string out;
+        out.reserve(body.size() + 128);
+        out += "HTTP/1.1 ";
+        out += status;
+        out += "\r\nContent-Type: ";
+        out += content_type;
+        out += "\r\nContent-Length: ";
+        out += std::to_string(body.size());
+        out += "\r\nConnection: close\r\n\r\n";
+        out += body;
+        return out;
+    }
+
+    // IPv4-mapped IPv6(::ffff:127.0.0.1) 로 받은 연결도 loopback 으로
+    bool is_loopback_peer(const tcp::socket& socket) {
+        boost::system::error_code ec;
+        auto address = socket.remote_endpoint(ec).address();
+        if (ec) return false;
+        if (address.is_v6() && address.to_v6().is_v4_mapped()) {
+            return boost::asio::ip::make_address_v4(boost::asio::ip::v4_mapped, address.to_v6()).is_loopback();
+        }
+        return address.is_loopback();
+    }
+}
+
+MetricsServer::MetricsServer(boost::asio::io_context& io, const std::string& bind_address, unsigned short port,
+    std::chrono::milliseconds request_timeout)
+    : acceptor_(io, tcp::endpoint(boost::asio::ip::make_address(bind_address), port)),
+    request_timeout_(request_timeout) {
+    add_route("/metrics", "text/plain; version=0.0.4; charset=utf-8", []() { return metrics::render_prometheus(); });
+}
+
+void MetricsServer::add_route(const std::string& path, std::string content_type, Render render) {
+    routes_[path] = Route{ std::move(content_type), std::move(render) };
+}
+
+void MetricsServer::add_action(const std::string& path, std::string content_type, Render run) {
+    actions_[path] = Route{ std::move(content_type), std::move(run) };
+}
+
+void MetricsServer::start() {
+    auto local = acceptor_.local_endpoint();
+    AppContext::instance().logger->info("[Metrics] listening on {}:{}", local.address().to_string(), local.port());
+    start_accept();
+}
+
+void MetricsServer::start_accept() {
+    acceptor_.async_accept([this](boost::system::error_code ec, tcp::socket socket) {
+        if (!ec) {
+            handle(std::make_shared<tcp::socket>(std::move(socket)));
+        }
+        else if (ec == boost::asio::error::operation_aborted) {
+            return;
+        }
+        start_accept();
+        });
+}
+
+void MetricsServer::handle(std::shared_ptr<tcp::socket> socket) {
+    // 요청 수신 ~ 응답 송신까지 한 번에 한도 (헤더를 안 보내거나 응답을 안 읽는 연결이 남지 않게)
+    auto deadline = std::make_shared<boost::asio::steady_timer>(socket->get_executor(), request_timeout_);
+    deadline->async_wait([socket](boost::system::error_code ec) {
+        if (ec) return;   // 정상 완료로 취소됨
+        boost::system::error_code ignored;
+        socket->close(ignored);   // 진행 중인 read/write 는 operation_aborted 로 끝남
+        });
+
+    auto request = std::make_shared<boost::asio::streambuf>(kMaxRequestHeaderBytes);
+    boost::asio::async_read_until(*socket, *request, "\r\n\r\n",
+        [this, socket, request, deadline](boost::system::error_code ec, std::size_t /*length*/) {
+            if (ec) {   // 헤더가 너무 길거나 끊김 / 시간 초과 → 그냥 닫음
+                deadline->cancel();
+                boost::system::error_code ignored;
+                socket->close(ignored);
+                return;
+            }
+            std::istream in(request.get());
+            std::string request_line;
+            std::getline(in, request_line);
+            if (!request_line.empty() && request_line.back() == '\r') request_line.pop_back();
+
+            auto response = std::make_shared<std::string>(respond(request_line, is_loopback_peer(*socket)));
+            boost::asio::async_write(*socket, boost::asio::buffer(*response),
+                [socket, response, deadline](boost::system::error_code, std::size_t) {
+                    deadline->cancel();
+                    boost::system::error_code ignored;
+                    socket->shutdown(tcp::socket::shutdown_both, ignored);
+                    socket->close(ignored);
+                });
+        });
+}
+
+std::string MetricsServer::respond(const std::string& request_line, bool loopback_peer) const {
+    // "GET /metrics HTTP/1.1" (쿼리 스트링은 무시), 관리 명령은 "POST /admin/... HTTP/1.1" (본문 없음)
+    size_t method_end = request_line.find(' ');
+    if (method_end == std::string::npos) {
+        return http_response("400 Bad Request", "text/plain", "bad request\n");
+    }
+    std::string method = request_line.substr(0, method_end);
+    const auto* table = method == "GET" ? &routes_ : method == "POST" ? &actions_ : nullptr;
+    if (!table) {
+        return http_response("405 Method Not Allowed", "text/plain", "only GET / POST\n");
+    }
+    size_t path_end = request_line.find(' ', method_end + 1);
+    std::string path = request_line.substr(method_end + 1, path_end == std::string::npos ? std::string::npos : path_end - method_end - 1);
+    path = path.substr(0, path.find('?'));
+
+    auto it = table->find(path);
+    if (it == table->end()) {
+        return http_response("404 Not Found", "text/plain", "not found\n");
+    }
+    if (table == &actions_ && !loopback_peer) {
+        AppContext::instance().logger->warn("[Metrics] loopback 이 아닌 곳에서 관리 명령 거부: {}", path);
+        return http_response("403 Forbidden", "text/plain", "admin actions are loopback only\n");
+    }
+    try {
+        return http_response("200 OK", it->second.content_type, it->second.render());
+    }
+    catch (const std::exception& e) {
+        AppContext::instance().logger->error("[Metrics] {} render 실패: {}", path, e.what());
+        return http_response("500 Internal Server Error", "text/plain", "error\n");
+    }
+}
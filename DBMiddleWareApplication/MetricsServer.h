@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// 모니터링용 최소 HTTP 리스너 (별도 포트, GET 만, 응답 후 연결 종료)
+// - 기본 bind 는 127.0.0.1 (metrics_bind_address), 인증이 없으므로 외부 노출은 방화벽/프록시 뒤에서만
+// - 연결마다 request_timeout 안에 요청을 받고 응답을 다 보내지 못하면 닫음 (느린/멈춘 클라이언트)
+// - /metrics : Prometheus text format (metrics::render_prometheus)
+// - add_route 로 경로 추가 가능 (본문 생성 함수는 요청마다 io 스레드에서 호출)
+// - add_action 은 POST 전용 관리 명령 (설정 reload 등, Windows 처럼 시그널이 없는 환경용)
+//   bind 주소와 상관없이 loopback 에서 온 연결만 실행 (그 외 403). 같은 호스트의 프록시를 거친 요청은 구분하지 못함
+// 트래픽은 스크레이프 몇 초에 1번 수준이라 성능보다 단순함 위주
+class MetricsServer {
+public:
+    using Render = std::function<std::string()>;
+
+    MetricsServer(boost::asio::io_context& io, const std::string& bind_address, unsigned short port,
+        std::chrono::milliseconds request_timeout);
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // start() 전에만 호출
+    void add_route(const std::string& path, std::string content_type, Render render);
+    void add_action(const std::string& path, std::string content_type, Render run);
+    void start();
+
+private:
+    struct Route {
+        std::string content_type;
+        Render render;
+    };
+
+    void start_accept();
+    void handle(std::shared_ptr<boost::asio::ip::tcp::socket> socket);
+    std::string respond(const std::string& request_line, bool loopback_peer) const;
+
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::chrono::milliseconds request_timeout_;
+    std::unordered_map<std::string, Route> routes_;    // GET
+    std::unordered_map<std::string, Route> actions_;   // POST
+};
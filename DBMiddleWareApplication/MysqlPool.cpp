@@ -1,76 +1,552 @@
-﻿#include "MySqlPool.h"
+﻿#include "MysqlPool.h"
 #include "AppContext.h" // spdlog 헤더 대신 AppContext.h를 포함합니다.
+#include <cctype>
+#include <algorithm>
+#include <sstream>
 
 MySqlPool::MySqlPool(const std::string& host,
     unsigned int port,
     const std::string& user,
     const std::string& pass,
     const std::string& schema,
-    size_t pool_size)
+    size_t pool_size,
+    const MySqlPoolOptions& options)
     : host_(host), port_(port), user_(user), pass_(pass), schema_(schema),
-    capacity_(pool_size)
+    capacity_(pool_size), stmt_cache_capacity_(options.stmt_cache_capacity),
+    max_connections_(std::max(pool_size, options.max_connections)),
+    acquire_timeout_(options.acquire_timeout),
+    health_interval_(options.health_interval),
+    health_idle_threshold_(options.health_idle_threshold),
+    max_lifetime_(options.max_lifetime)
 {
     // spdlog::info -> AppContext::instance().logger->info
     AppContext::instance().logger->info("[MySqlPool] Initializing pool for {}@{}:{}/{} size={}", user_, host_, port_, schema_, capacity_);
 
-    std::unique_lock<std::mutex> lk(mtx_);
-    size_t ok = 0, fail = 0;
-    for (size_t i = 0; i < capacity_; ++i) {
+    // 슬롯은 먼저 전부 예약하고, 실제 연결은 여러 스레드가 병렬로 (mtx_ 잡은 채 연결하지 않음)
+    // 준비되는 대로 idle 에 들어가거나 대기 중인 acquire() 에 바로 넘어감
+    open_count_ = capacity_;
+    size_t threads = std::min(capacity_, std::max<size_t>(1, options.warmup_threads));
+    for (size_t i = 0; i < threads; ++i) {
+        warmup_threads_.emplace_back([this]() { warmup_loop(); });
+    }
+
+    if (health_interval_.count() > 0) {
+        health_thread_ = std::thread([this]() { health_loop(); });
+    }
+}
+
+MySqlPool::~MySqlPool() {
+    {
+        std::scoped_lock lk(health_mtx_);
+        stopping_ = true;
+    }
+    health_cv_.notify_all();
+    if (health_thread_.joinable()) health_thread_.join();
+    for (auto& t : warmup_threads_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void MySqlPool::warmup_loop() {
+    for (;;) {
+        size_t i = warmup_next_.fetch_add(1);
+        if (i >= capacity_) break;
+
+        std::unique_ptr<DbConnection> conn;
         try {
-            pool_.push(new_connection());
-            ++ok;
+            conn = new_connection();
         }
         catch (const mysqlx::Error& e) {
             // spdlog::error -> AppContext::instance().logger->error
             AppContext::instance().logger->error("[MySqlPool] Slot {} init failed: {}", i, e.what());
-            ++fail;
         }
         catch (const std::exception& e) {
             AppContext::instance().logger->error("[MySqlPool] Slot {} init failed (std::exception): {}", i, e.what());
-            ++fail;
         }
-    }
 
-    // spdlog::info -> AppContext::instance().logger->info
-    AppContext::instance().logger->info("[MySqlPool] Init done. capacity={}, created={}, failed={}", capacity_, ok, fail);
+        std::scoped_lock lk(mtx_);
+        if (conn) {
+            ++ready_count_;
+            return_idle_locked(std::move(conn));
+        }
+        else {
+            release_slot_locked();
+        }
+        if (++warmup_done_ == capacity_) {
+            // spdlog::info -> AppContext::instance().logger->info
+            AppContext::instance().logger->info("[MySqlPool] Init done. capacity={}, max_connections={}, created={}, failed={}",
+                capacity_, max_connections_, ready_count_, capacity_ - ready_count_);
+        }
+        ready_cv_.notify_all();
+    }
 }
 
-MySqlPool::~MySqlPool() = default;
+bool MySqlPool::wait_ready(size_t min_ready, std::chrono::milliseconds timeout) {
+    min_ready = std::min(min_ready, capacity_);
+    std::unique_lock<std::mutex> lk(mtx_);
+    ready_cv_.wait_for(lk, timeout, [&]() {
+        return ready_count_ >= min_ready || warmup_done_ >= capacity_;
+    });
+    return ready_count_ >= min_ready;
+}
 
 // new_connection, acquire, release 함수는 변경할 필요가 없습니다.
-std::unique_ptr<mysqlx::Session> MySqlPool::new_connection() {
+std::unique_ptr<DbConnection> MySqlPool::new_connection() {
     auto session = std::make_unique<mysqlx::Session>(host_, port_, user_, pass_);
     if (!schema_.empty()) {
         session->sql("USE " + schema_).execute();
     }
-    return session;
+    return std::make_unique<DbConnection>(std::move(session), stmt_cache_capacity_, &stmt_stats_);
+}
+
+std::unique_ptr<DbConnection> MySqlPool::acquire() {
+    return acquire(acquire_timeout_);
+}
+
+std::unique_ptr<DbConnection> MySqlPool::acquire(std::chrono::milliseconds timeout) {
+    auto start = std::chrono::steady_clock::now();
+    acquires_.fetch_add(1, std::memory_order_relaxed);
+
+    std::unique_lock<std::mutex> lk(mtx_);
+
+    // (1) idle 커넥션이 있고 앞선 대기자가 없으면 바로
+    if (waiters_.empty() && !pool_.empty()) {
+        auto conn = std::move(pool_.front());
+        pool_.pop();
+        ++in_use_;
+        lk.unlock();
+        record_wait(std::chrono::steady_clock::now() - start);
+        return conn;
+    }
+
+    // (2) 상한 이내면 새로 연결 (슬롯 먼저 예약, 연결은 락 밖에서)
+    if (waiters_.empty() && open_count_ < max_connections_) {
+        ++open_count_;
+        lk.unlock();
+        auto conn = open_reserved_slot();
+        record_wait(std::chrono::steady_clock::now() - start);
+        return conn;
+    }
+
+    // (3) 상한 도달 → FIFO 대기 (release/discard 가 직접 넘겨줌)
+    Waiter w;
+    waiters_.push_back(&w);
+    bool ready = w.cv.wait_until(lk, start + timeout, [&w]() { return w.ready; });
+    if (!ready) {
+        waiters_.erase(std::find(waiters_.begin(), waiters_.end(), &w));
+        lk.unlock();
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+        record_wait(std::chrono::steady_clock::now() - start);
+        AppContext::instance().logger->warn("[MySqlPool] acquire timed out after {}ms (max_connections={})", timeout.count(), max_connections_);
+        return nullptr;
+    }
+
+    // 커넥션을 넘겨받았거나, 폐기된 커넥션의 슬롯을 넘겨받음
+    auto conn = std::move(w.conn);
+    lk.unlock();
+    if (!conn) {
+        conn = open_reserved_slot();
+    }
+    record_wait(std::chrono::steady_clock::now() - start);
+    return conn;
+}
+
+std::unique_ptr<DbConnection> MySqlPool::open_reserved_slot() {
+    try {
+        auto conn = new_connection();
+        std::scoped_lock lk(mtx_);
+        ++in_use_;
+        return conn;
+    }
+    catch (const std::exception& e) {
+        AppContext::instance().logger->error("[MySqlPool] Failed to create a new connection on demand: {}", e.what());
+    }
+    catch (...) {
+        AppContext::instance().logger->error("[MySqlPool] Failed to create a new connection on demand.");
+    }
+    // 슬롯 반납 (다음 대기자가 재시도할 수 있게)
+    std::scoped_lock lk(mtx_);
+    release_slot_locked();
+    return nullptr;
+}
+
+void MySqlPool::hand_off_locked(std::unique_ptr<DbConnection> conn) {
+    Waiter* w = waiters_.front();
+    waiters_.pop_front();
+    w->conn = std::move(conn);
+    w->ready = true;
+    w->cv.notify_one();
+}
+
+void MySqlPool::return_idle_locked(std::unique_ptr<DbConnection> conn) {
+    if (!waiters_.empty()) {
+        ++in_use_;   // 대기자에게 그대로 넘어감
+        hand_off_locked(std::move(conn));
+        return;
+    }
+    pool_.push(std::move(conn));
 }
 
-std::unique_ptr<mysqlx::Session> MySqlPool::acquire() {
-    std::unique_ptr<mysqlx::Session> session;
+void MySqlPool::release_slot_locked() {
+    if (!waiters_.empty()) {
+        hand_off_locked(nullptr);   // 슬롯을 대기자에게 넘겨서 새로 연결하게 함
+        return;
+    }
+    --open_count_;
+}
+
+void MySqlPool::release(std::unique_ptr<DbConnection> conn) {
+    if (!conn) return;
+    conn->touch();
+    std::scoped_lock lk(mtx_);
+    --in_use_;
+    return_idle_locked(std::move(conn));
+}
+
+void MySqlPool::discard(std::unique_ptr<DbConnection> conn) {
+    if (!conn) return;
+    conn.reset();   // 연결 종료는 락 밖에서
+
+    std::scoped_lock lk(mtx_);
+    --in_use_;
+    release_slot_locked();
+}
+
+bool MySqlPool::ping(DbConnection& conn) {
+    health_checks_.fetch_add(1, std::memory_order_relaxed);
+    try {
+        conn.session().sql("SELECT 1").execute();
+        conn.clear_suspect();
+        conn.touch();
+        return true;
+    }
+    catch (const std::exception& e) {
+        health_failures_.fetch_add(1, std::memory_order_relaxed);
+        AppContext::instance().logger->warn("[MySqlPool] ping failed: {}", e.what());
+        return false;
+    }
+}
+
+void MySqlPool::health_loop() {
+    std::unique_lock<std::mutex> lk(health_mtx_);
+    while (!stopping_) {
+        health_cv_.wait_for(lk, health_interval_, [this]() { return stopping_; });
+        if (stopping_) break;
+        lk.unlock();
+        try {
+            health_check_round();
+        }
+        catch (const std::exception& e) {
+            AppContext::instance().logger->error("[MySqlPool] health check exception: {}", e.what());
+        }
+        lk.lock();
+    }
+}
+
+// idle 커넥션을 한 번에 하나씩만 꺼내서 검사 → acquire() 는 락을 잠깐만 기다림
+// ping/재연결은 전부 락 밖에서 수행
+void MySqlPool::health_check_round() {
+    size_t budget;
     {
         std::scoped_lock lk(mtx_);
-        if (!pool_.empty()) {
-            session = std::move(pool_.front());
+        budget = pool_.size();
+    }
+
+    // idle 전체를 한 바퀴 돎: 검사 대상이 아니면 그대로 뒤로 (순서 유지)
+    // (앞쪽이 가장 오래 논 커넥션이지만 수명 초과는 idle 순서와 무관해서 중간에 멈추지 않음)
+    for (size_t n = 0; n < budget; ++n) {
+        std::unique_ptr<DbConnection> conn;
+        {
+            std::scoped_lock lk(mtx_);
+            if (pool_.empty()) break;
+            auto now = std::chrono::steady_clock::now();
+            auto& front = pool_.front();
+            bool expired = max_lifetime_.count() > 0 && now - front->created_at() > max_lifetime_;
+            bool stale = now - front->last_used() >= health_idle_threshold_;
+            conn = std::move(pool_.front());
             pool_.pop();
+            if (!expired && !stale) {
+                return_idle_locked(std::move(conn));
+                continue;
+            }
         }
+
+        bool expired = max_lifetime_.count() > 0
+            && std::chrono::steady_clock::now() - conn->created_at() > max_lifetime_;
+        if (!expired && ping(*conn)) {
+            std::scoped_lock lk(mtx_);
+            return_idle_locked(std::move(conn));
+            continue;
+        }
+
+        // 깨졌거나 수명 초과 → 교체 (슬롯은 유지한 채 새로 연결)
+        conn.reset();
+        replaced_.fetch_add(1, std::memory_order_relaxed);
+        std::unique_ptr<DbConnection> fresh;
+        try {
+            fresh = new_connection();
+        }
+        catch (const std::exception& e) {
+            AppContext::instance().logger->error("[MySqlPool] replacement connection failed: {}", e.what());
+        }
+        std::scoped_lock lk(mtx_);
+        if (fresh) return_idle_locked(std::move(fresh));
+        else release_slot_locked();   // 아래 refill 이 다음 라운드부터 다시 채움
     }
-    if (!session) {
+
+    refill();
+}
+
+// 교체/연결 실패나 discard 로 반납된 슬롯을 pool_size 까지 다시 채움
+// 한 번이라도 실패하면 (DB 가 아직 안 살아남) 이번 라운드는 중단, 다음 라운드에 재시도
+void MySqlPool::refill() {
+    size_t opened = 0;
+    for (;;) {
+        {
+            std::scoped_lock lk(mtx_);
+            if (open_count_ >= capacity_) break;
+            ++open_count_;
+        }
+        std::unique_ptr<DbConnection> fresh;
         try {
-            session = new_connection();
+            fresh = new_connection();
         }
-        catch (...) {
-            AppContext::instance().logger->error("[MySqlPool] Failed to create a new connection on demand.");
-            return nullptr;
+        catch (const std::exception& e) {
+            AppContext::instance().logger->warn("[MySqlPool] refill connection failed: {}", e.what());
         }
+        std::scoped_lock lk(mtx_);
+        if (!fresh) {
+            release_slot_locked();
+            break;
+        }
+        return_idle_locked(std::move(fresh));
+        ++opened;
+    }
+    if (opened > 0) {
+        AppContext::instance().logger->info("[MySqlPool] refilled {} connection(s) toward pool size {}", opened, capacity_);
     }
-    return session;
 }
 
-void MySqlPool::release(std::unique_ptr<mysqlx::Session> session) {
-    if (!session) return;
-    std::scoped_lock lk(mtx_);
-    if (pool_.size() < capacity_) {
-        pool_.push(std::move(session));
+void MySqlPool::record_wait(std::chrono::steady_clock::duration waited) {
+    uint64_t us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(waited).count());
+    wait_sum_us_.fetch_add(us, std::memory_order_relaxed);
+    size_t bucket = 0;
+    while (bucket < MySqlPoolStats::kWaitBoundsUs.size() && us >= MySqlPoolStats::kWaitBoundsUs[bucket]) {
+        ++bucket;
+    }
+    wait_buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+MySqlPoolStats MySqlPool::stats() {
+    MySqlPoolStats st;
+    {
+        std::scoped_lock lk(mtx_);
+        st.open = open_count_;
+        st.idle = pool_.size();
+        st.in_use = in_use_;
+        st.waiters = waiters_.size();
+        st.ready = ready_count_;
+    }
+    st.health_checks = health_checks_.load(std::memory_order_relaxed);
+    st.health_failures = health_failures_.load(std::memory_order_relaxed);
+    st.replaced = replaced_.load(std::memory_order_relaxed);
+    st.max_connections = max_connections_;
+    st.acquires = acquires_.load(std::memory_order_relaxed);
+    st.timeouts = timeouts_.load(std::memory_order_relaxed);
+    st.wait_sum_us = wait_sum_us_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < st.wait_buckets.size(); ++i) {
+        st.wait_buckets[i] = wait_buckets_[i].load(std::memory_order_relaxed);
     }
-}
\ No newline at end of file
+    return st;
+}
+
+// ===== StatementCache =====
+StatementCache::StatementCache(size_t capacity, StatementCacheStats* stats)
+    : capacity_(capacity == 0 ? 1 : capacity), stats_(stats) {
+}
+
+CachedStatement& StatementCache::get_or_build(const std::string& key, const std::function<PreparedShape()>& builder) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // hit → 맨 앞으로 이동
+        lru_.splice(lru_.begin(), lru_, it->second);
+        if (stats_) stats_->hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second->second;
+    }
+
+    if (stats_) stats_->misses.fetch_add(1, std::memory_order_relaxed);
+    if (index_.size() >= capacity_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+        if (stats_) stats_->evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    lru_.emplace_front(key, CachedStatement{ builder() });
+    index_[key] = lru_.begin();
+    return lru_.front().second;
+}
+
+// ===== DbConnection =====
+DbConnection::DbConnection(std::unique_ptr<mysqlx::Session> session, size_t stmt_cache_capacity, StatementCacheStats* stats)
+    : session_(std::move(session)), stmt_cache_(stmt_cache_capacity, stats),
+    created_at_(std::chrono::steady_clock::now()), last_used_(created_at_) {
+}
+
+mysqlx::SqlResult DbConnection::execute(const std::string& shape_key,
+    const std::function<PreparedShape()>& builder,
+    const std::vector<mysqlx::Value>& params) {
+    CachedStatement& cached = stmt_cache_.get_or_build(shape_key, builder);
+    if (cached.shape.param_count != params.size()) {
+        throw std::runtime_error("parameter count mismatch for " + shape_key);
+    }
+    try {
+        mysqlx::SqlStatement stmt = session_->sql(cached.shape.sql);
+        for (const auto& p : params) {
+            stmt.bind(p);
+        }
+        return stmt.execute();
+    }
+    catch (const mysqlx::Error&) {
+        suspect_ = true;   // 쿼리 오류인지 연결 오류인지 구분 불가 → 다음 재사용 전 ping
+        throw;
+    }
+}
+
+uint64_t DbConnection::auto_increment_increment() {
+    if (!auto_increment_increment_) {
+        try {
+            mysqlx::Row row = session_->sql("SELECT @@session.auto_increment_increment").execute().fetchOne();
+            auto_increment_increment_ = row ? row[0].get<uint64_t>() : 1;
+        }
+        catch (const mysqlx::Error&) {
+            suspect_ = true;
+            return 1;
+        }
+    }
+    return *auto_increment_increment_;
+}
+
+// ===== SQL 모양/바인딩 헬퍼 =====
+bool is_valid_identifier(const std::string& name) {
+    if (name.empty() || name.size() > 64) return false;
+    for (unsigned char c : name) {
+        if (!(std::isalnum(c) || c == '_' || c == '$')) return false;
+    }
+    return true;
+}
+
+std::string make_shape_key(const char* kind, const std::string& table, const std::vector<std::string>& columns, size_t rows) {
+    std::string key = kind;
+    key += '\x1f';
+    key += table;
+    for (const auto& c : columns) {
+        key += '\x1f';
+        key += c;
+    }
+    key += '#';
+    key += std::to_string(rows);
+    return key;
+}
+
+PreparedShape build_insert_shape(const std::string& table, const std::vector<std::string>& columns, size_t rows) {
+    PreparedShape shape;
+    std::string& sql = shape.sql;
+    sql = "INSERT INTO `" + table + "` (";
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (c) sql += ", ";
+        sql += '`';
+        sql += columns[c];
+        sql += '`';
+    }
+    sql += ") VALUES ";
+    for (size_t r = 0; r < rows; ++r) {
+        if (r) sql += ", ";
+        sql += '(';
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (c) sql += ", ";
+            sql += '?';
+        }
+        sql += ')';
+    }
+    shape.param_count = rows * columns.size();
+    return shape;
+}
+
+PreparedShape build_select_shape(const std::string& table, const std::vector<std::string>& columns,
+    const std::vector<std::string>& where_columns) {
+    PreparedShape shape;
+    std::string& sql = shape.sql;
+    sql = "SELECT ";
+    if (columns.empty()) {
+        sql += '*';
+    }
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (c) sql += ", ";
+        sql += '`';
+        sql += columns[c];
+        sql += '`';
+    }
+    sql += " FROM `" + table + "`";
+    for (size_t w = 0; w < where_columns.size(); ++w) {
+        sql += w ? " AND `" : " WHERE `";
+        sql += where_columns[w];
+        sql += "` <=> ?";
+    }
+    sql += " LIMIT ?";
+    shape.param_count = where_columns.size() + 1;
+    return shape;
+}
+
+std::string make_select_shape_key(const std::string& table, const std::vector<std::string>& columns,
+    const std::vector<std::string>& where_columns) {
+    std::string key = make_shape_key("select", table, columns);
+    for (const auto& w : where_columns) {
+        key += '\x1e';
+        key += w;
+    }
+    return key;
+}
+
+mysqlx::Value json_to_db_value(const nlohmann::json& v) {
+    switch (v.type()) {
+    case nlohmann::json::value_t::null:            return mysqlx::Value(nullptr);
+    case nlohmann::json::value_t::boolean:         return mysqlx::Value(v.get<bool>());
+    case nlohmann::json::value_t::number_integer:  return mysqlx::Value(v.get<int64_t>());
+    case nlohmann::json::value_t::number_unsigned: return mysqlx::Value(v.get<uint64_t>());
+    case nlohmann::json::value_t::number_float:    return mysqlx::Value(v.get<double>());
+    case nlohmann::json::value_t::string:          return mysqlx::Value(v.get<std::string>());
+    default:                                       return mysqlx::Value(v.dump());   // object/array
+    }
+}
+
+nlohmann::json db_value_to_json(const mysqlx::Value& v) {
+    switch (v.getType()) {
+    case mysqlx::Value::VNULL:  return nullptr;
+    case mysqlx::Value::UINT64: return v.get<uint64_t>();
+    case mysqlx::Value::INT64:  return v.get<int64_t>();
+    case mysqlx::Value::FLOAT:  return v.get<float>();
+    case mysqlx::Value::DOUBLE: return v.get<double>();
+    case mysqlx::Value::BOOL:   return v.get<bool>();
+    case mysqlx::Value::STRING: return v.get<std::string>();
+    default: {
+        std::ostringstream oss;   // DECIMAL/날짜/RAW/문서 등
+        oss << v;
+        return oss.str();
+    }
+    }
+}
+
+nlohmann::json result_column_names(mysqlx::SqlResult& res) {
+    nlohmann::json names = nlohmann::json::array();
+    for (unsigned i = 0; i < res.getColumnCount(); ++i) {
+        names.push_back(std::string(res.getColumn(i).getColumnLabel()));
+    }
+    return names;
+}
+
+nlohmann::json row_to_json(mysqlx::Row& row) {
+    nlohmann::json values = nlohmann::json::array();
+    for (unsigned i = 0; i < row.colCount(); ++i) {
+        values.push_back(db_value_to_json(row[i]));
+    }
+    return values;
+}
@@ -4,9 +4,153 @@
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <list>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <deque>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <optional>
 
 // MySQL Connector/C++ 8.x (X DevAPI)
 #include <mysqlx/xdevapi.h>
+#include <nlohmann/json.hpp>
+
+// 정규화된 SQL 모양(종류 + 테이블 + 컬럼 목록) 하나에 대응하는 파라미터화된 SQL
+struct PreparedShape {
+    std::string sql;            // 값 자리는 전부 '?' placeholder
+    size_t param_count = 0;
+};
+
+// 캐시 항목: SQL 모양 하나의 파라미터화된 SQL (모양마다 SQL 문자열을 다시 만들지 않음)
+// statement 객체는 보관하지 않음: bind 값을 비우는 방법(SqlStatement::clear)이 빌드하는 커넥터 헤더에서 확인되지 않아
+// 실행마다 session.sql() 로 새로 만들고 값을 bind (이전 실행의 값이 남을 여지 없음)
+struct CachedStatement {
+    PreparedShape shape;
+};
+
+// statement 캐시 hit/miss 카운터 (풀 전체 합산, 캐시 크기 조정용)
+struct StatementCacheStats {
+    std::atomic<uint64_t> hits{ 0 };
+    std::atomic<uint64_t> misses{ 0 };
+    std::atomic<uint64_t> evictions{ 0 };
+};
+
+// 커넥션별 LRU statement 캐시 (커넥션은 한 번에 한 워커만 쓰므로 락 없음)
+class StatementCache {
+public:
+    StatementCache(size_t capacity, StatementCacheStats* stats);
+
+    // key 로 조회, 없으면 builder() 로 만들어 넣음. 용량 초과 시 가장 오래 안 쓴 항목 제거
+    CachedStatement& get_or_build(const std::string& key, const std::function<PreparedShape()>& builder);
+
+    size_t size() const { return index_.size(); }
+
+private:
+    using Entry = std::pair<std::string, CachedStatement>;
+
+    size_t capacity_;
+    StatementCacheStats* stats_;
+    std::list<Entry> lru_;                                              // 앞쪽이 최근 사용
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+// 풀에서 빌려주는 커넥션 단위: mysqlx 세션 + 전용 statement 캐시
+class DbConnection {
+public:
+    DbConnection(std::unique_ptr<mysqlx::Session> session, size_t stmt_cache_capacity, StatementCacheStats* stats);
+
+    mysqlx::Session& session() { return *session_; }
+
+    // shape_key 에 해당하는 SQL 을 캐시에서 꺼내 새 statement 에 params 를 bind 해서 실행
+    mysqlx::SqlResult execute(const std::string& shape_key,
+        const std::function<PreparedShape()>& builder,
+        const std::vector<mysqlx::Value>& params);
+
+    StatementCache& stmt_cache() { return stmt_cache_; }
+
+    // 세션의 auto_increment_increment (multi-row INSERT 의 행별 id 계산용, 첫 호출 때 한 번 조회)
+    // 조회 실패 시 서버 기본값 1 (커넥션은 suspect 로 표시)
+    uint64_t auto_increment_increment();
+
+    // 헬스 체크용 정보
+    std::chrono::steady_clock::time_point created_at() const { return created_at_; }
+    std::chrono::steady_clock::time_point last_used() const { return last_used_; }
+    void touch() { last_used_ = std::chrono::steady_clock::now(); }
+    bool is_suspect() const { return suspect_; }     // 실행 중 예외 발생 → 재사용 전 ping 필요
+    void clear_suspect() { suspect_ = false; }
+    void mark_suspect() { suspect_ = true; }         // 결과를 다 읽지 않고 중단한 경우 등
+
+private:
+    std::unique_ptr<mysqlx::Session> session_;
+    StatementCache stmt_cache_;
+    std::chrono::steady_clock::time_point created_at_;
+    std::chrono::steady_clock::time_point last_used_;
+    bool suspect_ = false;
+    std::optional<uint64_t> auto_increment_increment_;
+};
+
+// ---- SQL 모양/바인딩 헬퍼 ----
+// 테이블/컬럼명은 bind 할 수 없으므로 식별자 규칙([A-Za-z0-9_$], 1~64자)을 통과한 것만 허용
+bool is_valid_identifier(const std::string& name);
+
+// 캐시 key: kind + table + 컬럼 목록 (+ 행 수)
+std::string make_shape_key(const char* kind, const std::string& table, const std::vector<std::string>& columns, size_t rows = 1);
+
+// INSERT INTO `t` (`a`, `b`) VALUES (?, ?), (?, ?) ...
+PreparedShape build_insert_shape(const std::string& table, const std::vector<std::string>& columns, size_t rows);
+
+// SELECT `a`, `b` FROM `t` WHERE `x` <=> ? AND ... LIMIT ?   (columns 가 비면 *, where 는 NULL 도 일치하는 <=>)
+PreparedShape build_select_shape(const std::string& table, const std::vector<std::string>& columns,
+    const std::vector<std::string>& where_columns);
+std::string make_select_shape_key(const std::string& table, const std::vector<std::string>& columns,
+    const std::vector<std::string>& where_columns);
+
+// JSON 값 → bind 용 mysqlx::Value (object/array 는 JSON 문자열로)
+mysqlx::Value json_to_db_value(const nlohmann::json& v);
+// 조회 결과 값 → JSON (바이너리/문서 등은 문자열로)
+nlohmann::json db_value_to_json(const mysqlx::Value& v);
+// 조회 결과의 컬럼 label 목록 / 행 1개 → JSON 배열 (select, select_stream 공용)
+nlohmann::json result_column_names(mysqlx::SqlResult& res);
+nlohmann::json row_to_json(mysqlx::Row& row);
+
+// 풀 동작 옵션
+struct MySqlPoolOptions {
+    size_t stmt_cache_capacity = 64;                       // 커넥션별 statement 캐시 크기
+    size_t max_connections = 0;                            // 동시에 열 수 있는 최대 커넥션 수 (0 = pool_size)
+    std::chrono::milliseconds acquire_timeout{ 2000 };     // acquire() 기본 대기 한도
+
+    size_t warmup_threads = 8;                             // 시작 시 병렬로 연결할 스레드 수
+    std::chrono::milliseconds health_interval{ 10000 };    // 백그라운드 헬스 체크 + pool_size 로 refill 주기 (0 = 끔)
+    std::chrono::milliseconds health_idle_threshold{ 30000 };  // 이 시간 이상 놀던 커넥션만 ping
+    std::chrono::seconds max_lifetime{ 3600 };             // 이보다 오래된 커넥션은 교체 (0 = 무제한)
+};
+
+// 풀 포화 상태 스냅샷 (모니터링용)
+struct MySqlPoolStats {
+    static constexpr size_t kWaitBuckets = 10;
+    // acquire 대기 시간 히스토그램 상한(us). 마지막 버킷은 그 이상 전부
+    static constexpr std::array<uint64_t, kWaitBuckets - 1> kWaitBoundsUs{
+        100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000 };
+
+    size_t open = 0;          // 열린 커넥션 (idle + in_use + 생성 중)
+    size_t idle = 0;
+    size_t in_use = 0;
+    size_t waiters = 0;
+    size_t max_connections = 0;
+    size_t ready = 0;         // 시작 시 warm-up 으로 준비된 커넥션 수
+    uint64_t health_checks = 0;
+    uint64_t health_failures = 0;
+    uint64_t replaced = 0;    // 깨졌거나 수명이 다해서 교체된 커넥션
+    uint64_t acquires = 0;
+    uint64_t timeouts = 0;
+    uint64_t wait_sum_us = 0;
+    std::array<uint64_t, kWaitBuckets> wait_buckets{};
+};
 
 class MySqlPool {
 public:
@@ -15,7 +159,8 @@ public:
         const std::string& user,
         const std::string& pass,
         const std::string& schema,
-        size_t pool_size);
+        size_t pool_size,
+        const MySqlPoolOptions& options = {});
     ~MySqlPool();
 
     // 복사/이동 금지
@@ -24,12 +169,44 @@ public:
     MySqlPool(MySqlPool&&) = delete;
     MySqlPool& operator=(MySqlPool&&) = delete;
 
-    // 세션 빌림/반납
-    std::unique_ptr<mysqlx::Session> acquire();
-    void release(std::unique_ptr<mysqlx::Session> session);
+    // 커넥션 빌림/반납
+    // - idle 이 없고 max_connections 에 도달했으면 timeout 까지 FIFO 순서로 대기, 초과 시 nullptr
+    std::unique_ptr<DbConnection> acquire();
+    std::unique_ptr<DbConnection> acquire(std::chrono::milliseconds timeout);
+    void release(std::unique_ptr<DbConnection> conn);
+    // 깨진 커넥션 폐기 (슬롯을 반환해서 대기자가 새로 연결할 수 있게 함)
+    void discard(std::unique_ptr<DbConnection> conn);
+    // 가벼운 liveness 확인 (SELECT 1). 호출 스레드에서 블로킹
+    bool ping(DbConnection& conn);
+
+    // warm-up 으로 min_ready 개가 준비될 때까지(또는 전부 시도 끝날 때까지) 대기
+    bool wait_ready(size_t min_ready, std::chrono::milliseconds timeout);
+
+    MySqlPoolStats stats();
+
+    // statement 캐시 통계
+    uint64_t stmt_cache_hits() const { return stmt_stats_.hits.load(std::memory_order_relaxed); }
+    uint64_t stmt_cache_misses() const { return stmt_stats_.misses.load(std::memory_order_relaxed); }
+    uint64_t stmt_cache_evictions() const { return stmt_stats_.evictions.load(std::memory_order_relaxed); }
 
 private:
-    std::unique_ptr<mysqlx::Session> new_connection();
+    // acquire 대기자: release/discard 가 맨 앞 대기자에게 직접 넘겨줌 (FIFO 공정성)
+    struct Waiter {
+        std::condition_variable cv;
+        std::unique_ptr<DbConnection> conn;
+        bool ready = false;           // conn 을 받았거나, 새로 연결할 슬롯을 받음
+    };
+
+    std::unique_ptr<DbConnection> new_connection();
+    std::unique_ptr<DbConnection> open_reserved_slot();   // open_count_ 를 이미 올린 상태에서 연결
+    void hand_off_locked(std::unique_ptr<DbConnection> conn);
+    void return_idle_locked(std::unique_ptr<DbConnection> conn);   // 대기자 우선, 없으면 idle 로
+    void release_slot_locked();                                      // 연결 실패/폐기로 슬롯 반납
+    void warmup_loop();
+    void health_loop();
+    void health_check_round();
+    void refill();                                                   // open 수가 pool_size 보다 적으면 새로 연결
+    void record_wait(std::chrono::steady_clock::duration waited);
 
 private:
     // 연결 정보
@@ -39,7 +216,40 @@ private:
     std::string pass_;
     std::string schema_;
     size_t      capacity_ = 0;
+    size_t      stmt_cache_capacity_ = 64;
+    size_t      max_connections_ = 0;
+    std::chrono::milliseconds acquire_timeout_{ 2000 };
+
+    StatementCacheStats stmt_stats_;
 
     std::mutex mtx_;
-    std::queue<std::unique_ptr<mysqlx::Session>> pool_;
+    std::queue<std::unique_ptr<DbConnection>> pool_;   // idle 커넥션
+    std::deque<Waiter*> waiters_;
+    size_t open_count_ = 0;
+    size_t in_use_ = 0;
+
+    // 병렬 warm-up
+    std::vector<std::thread> warmup_threads_;
+    std::atomic<size_t> warmup_next_{ 0 };
+    size_t warmup_done_ = 0;        // 시도 끝난 슬롯 수 (mtx_)
+    size_t ready_count_ = 0;        // 성공한 슬롯 수 (mtx_)
+    std::condition_variable ready_cv_;
+
+    // 백그라운드 헬스 체크
+    std::chrono::milliseconds health_interval_{ 10000 };
+    std::chrono::milliseconds health_idle_threshold_{ 30000 };
+    std::chrono::seconds max_lifetime_{ 3600 };
+    std::thread health_thread_;
+    std::mutex health_mtx_;
+    std::condition_variable health_cv_;
+    bool stopping_ = false;         // health_mtx_
+    std::atomic<uint64_t> health_checks_{ 0 };
+    std::atomic<uint64_t> health_failures_{ 0 };
+    std::atomic<uint64_t> replaced_{ 0 };
+
+    // acquire 대기 통계
+    std::atomic<uint64_t> acquires_{ 0 };
+    std::atomic<uint64_t> timeouts_{ 0 };
+    std::atomic<uint64_t> wait_sum_us_{ 0 };
+    std::array<std::atomic<uint64_t>, MySqlPoolStats::kWaitBuckets> wait_buckets_{};
 };
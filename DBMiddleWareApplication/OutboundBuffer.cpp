@@ -0,0 +1,92 @@
+﻿#include "OutboundBuffer.h"
+#include <array>
+#include <vector>
+#include <cstring>
+#include <new>
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+namespace {
+    // slab 크기 클래스 (본문 최대 길이). 이보다 큰 메시지는 매번 할당/해제
+    constexpr std::array<uint32_t, 4> kClassCapacity{ 256, 1024, 4096, 16384 };
+    constexpr uint8_t kNoClass = 0xFF;
+    constexpr size_t kMaxFreePerClass = 256;   // 스레드당 클래스별 보관 상한
+
+    // 스레드별 free list: 블록은 다른 스레드에서 반납돼도 그 스레드 캐시로 들어감
+    struct SlabCache {
+        std::array<std::vector<void*>, kClassCapacity.size()> free;
+
+        ~SlabCache() {
+            for (auto& list : free) {
+                for (void* p : list) ::operator delete(p);
+            }
+        }
+    };
+
+    SlabCache& slab_cache() {
+        thread_local SlabCache cache;
+        return cache;
+    }
+
+    uint8_t size_class_for(size_t body_size) {
+        for (uint8_t i = 0; i < kClassCapacity.size(); ++i) {
+            if (body_size <= kClassCapacity[i]) return i;
+        }
+        return kNoClass;
+    }
+
+    size_t block_size(uint32_t capacity) {
+        return sizeof(OutboundBuffer) + OutboundBuffer::kPrefixSize + capacity;
+    }
+}
+
+OutboundBuffer* OutboundBuffer::allocate(size_t body_size) {
+    uint8_t cls = size_class_for(body_size);
+    uint32_t capacity = cls == kNoClass ? static_cast<uint32_t>(body_size) : kClassCapacity[cls];
+
+    void* raw = nullptr;
+    if (cls != kNoClass) {
+        auto& list = slab_cache().free[cls];
+        if (!list.empty()) {
+            raw = list.back();
+            list.pop_back();
+        }
+    }
+    if (!raw) {
+        raw = ::operator new(block_size(capacity));
+    }
+
+    char* data = static_cast<char*>(raw) + sizeof(OutboundBuffer);
+    return new (raw) OutboundBuffer(data, capacity, cls);
+}
+
+void OutboundBuffer::recycle(OutboundBuffer* buf) {
+    uint8_t cls = buf->size_class_;
+    buf->~OutboundBuffer();
+    if (cls != kNoClass) {
+        auto& list = slab_cache().free[cls];
+        if (list.size() < kMaxFreePerClass) {
+            list.push_back(buf);
+            return;
+        }
+    }
+    ::operator delete(buf);
+}
+
+OutboundRef OutboundRef::make(std::string_view body) {
+    OutboundBuffer* buf = OutboundBuffer::allocate(body.size());
+    uint32_t len_net = htonl(static_cast<uint32_t>(body.size())); // 네트워크 바이트 오더(빅엔디안)
+    memcpy(buf->data_, &len_net, OutboundBuffer::kPrefixSize);
+    memcpy(buf->data_ + OutboundBuffer::kPrefixSize, body.data(), body.size());
+    buf->size_ = static_cast<uint32_t>(body.size());
+    return OutboundRef(buf);
+}
+
+OutboundRef OutboundRef::preframed(std::string_view body) {
+    OutboundRef ref = make(body);
+    ref.buf_->immortal_ = true;   // 해제되지 않음 (static 상수 응답 전용)
+    return ref;
+}
@@ -0,0 +1,88 @@
+﻿#pragma once
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+class OutboundRef;
+
+// 송신 메시지 버퍼: [4바이트 길이 프리픽스][본문] 을 한 블록에 보관
+// - 프리픽스 자리를 미리 잡아두고 생성 시 채우므로 전송 시 따로 만들 필요 없음
+// - 블록은 크기 클래스별 per-thread slab 에서 재사용 (write 완료 후 반납)
+// - 참조 카운트는 비원자: 생성 스레드 → strand 로 move 한 뒤에는 strand 안에서만 복사/해제
+// - preframed() 로 만든 상수 응답은 immortal: 카운트/반납 없이 여러 세션/스레드가 공유
+class OutboundBuffer {
+public:
+    static constexpr size_t kPrefixSize = 4;
+
+    std::string_view body() const { return { data_ + kPrefixSize, size_ }; }
+    const char* wire_data() const { return data_; }          // 프리픽스 포함
+    size_t wire_size() const { return kPrefixSize + size_; }
+
+private:
+    friend class OutboundRef;
+
+    OutboundBuffer(char* data, uint32_t capacity, uint8_t size_class)
+        : data_(data), capacity_(capacity), size_class_(size_class) {}
+
+    static OutboundBuffer* allocate(size_t body_size);
+    static void recycle(OutboundBuffer* buf);
+
+    char* data_;
+    uint32_t refs_ = 1;
+    uint32_t size_ = 0;
+    uint32_t capacity_;          // 본문 최대 길이
+    uint8_t size_class_;         // slab 클래스 (kNoClass 면 slab 밖에서 할당)
+    bool immortal_ = false;
+};
+
+// OutboundBuffer 참조 핸들 (intrusive, 비원자 카운트)
+class OutboundRef {
+public:
+    OutboundRef() = default;
+
+    // 본문을 복사해서 프리픽스가 채워진 버퍼 생성 (slab 재사용)
+    static OutboundRef make(std::string_view body);
+    // 상수 응답용: 프로세스 수명 동안 유지, 복사/해제 비용 0
+    static OutboundRef preframed(std::string_view body);
+
+    OutboundRef(const OutboundRef& other) : buf_(other.buf_) { retain(); }
+    OutboundRef(OutboundRef&& other) noexcept : buf_(std::exchange(other.buf_, nullptr)) {}
+    OutboundRef& operator=(const OutboundRef& other) {
+        if (this != &other) {
+            reset();
+            buf_ = other.buf_;
+            retain();
+        }
+        return *this;
+    }
+    OutboundRef& operator=(OutboundRef&& other) noexcept {
+        if (this != &other) {
+            reset();
+            buf_ = std::exchange(other.buf_, nullptr);
+        }
+        return *this;
+    }
+    ~OutboundRef() { reset(); }
+
+    explicit operator bool() const { return buf_ != nullptr; }
+    std::string_view body() const { return buf_->body(); }
+    const char* wire_data() const { return buf_->wire_data(); }
+    size_t wire_size() const { return buf_->wire_size(); }
+    size_t size() const { return buf_->size_; }
+
+    void reset() {
+        if (buf_ && !buf_->immortal_ && --buf_->refs_ == 0) {
+            OutboundBuffer::recycle(buf_);
+        }
+        buf_ = nullptr;
+    }
+
+private:
+    explicit OutboundRef(OutboundBuffer* buf) : buf_(buf) {}
+    void retain() {
+        if (buf_ && !buf_->immortal_) ++buf_->refs_;
+    }
+
+    OutboundBuffer* buf_ = nullptr;
+};
@@ -0,0 +1,142 @@
+﻿#include "QueryCache.h"
+#include <algorithm>
+#include <functional>
+#include "AppContext.h"
+
+QueryCache::QueryCache(size_t shard_count, size_t max_bytes)
+    : shards_(std::max<size_t>(1, shard_count)) {
+    shard_budget_ = std::max<size_t>(1, max_bytes / shards_.size());
+    max_entry_bytes_ = std::max<size_t>(1, shard_budget_ / 4);
+    AppContext::instance().logger->info("[QueryCache] shards={}, max_bytes={}, max_entry_bytes={}",
+        shards_.size(), shard_budget_ * shards_.size(), max_entry_bytes_);
+}
+
+uint32_t QueryCache::table_slot(const std::string& table) {
+    return static_cast<uint32_t>(std::hash<std::string>{}(table) % kGenerationSlots);
+}
+
+QueryCache::Shard& QueryCache::shard_for(const std::string& key) {
+    return shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+uint64_t QueryCache::table_generation(const std::string& table) const {
+    return generations_[table_slot(table)].load(std::memory_order_acquire);
+}
+
+void QueryCache::invalidate_table(const std::string& table) {
+    generations_[table_slot(table)].fetch_add(1, std::memory_order_acq_rel);
+    invalidations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool QueryCache::is_stale(const Entry& entry, clock::time_point now) const {
+    return now >= entry.expires ||
+        entry.generation != generations_[entry.table_slot].load(std::memory_order_acquire);
+}
+
+// 마지막 항목을 pos 로 옮겨서 지움 (O(1), hand 위치는 그대로 → 옮겨온 항목을 다음에 검사)
+void QueryCache::erase_locked(Shard& shard, size_t pos) {
+    Entry& victim = shard.entries[pos];
+    shard.bytes -= victim.bytes;
+    shard.index.erase(victim.key);
+    if (pos + 1 != shard.entries.size()) {
+        victim = std::move(shard.entries.back());
+        shard.index[victim.key] = pos;
+    }
+    shard.entries.pop_back();
+    if (shard.hand >= shard.entries.size()) shard.hand = 0;
+}
+
+// CLOCK: 참조 비트가 있으면 지우고 넘어가고, 없거나 이미 죽은 항목이면 회수
+bool QueryCache::evict_one_locked(Shard& shard, clock::time_point now) {
+    for (size_t scanned = 0; scanned < shard.entries.size() * 2 + 1 && !shard.entries.empty(); ++scanned) {
+        if (shard.hand >= shard.entries.size()) shard.hand = 0;
+        Entry& entry = shard.entries[shard.hand];
+        if (is_stale(entry, now)) {
+            ++shard.stale;
+            erase_locked(shard, shard.hand);
+            return true;
+        }
+        if (entry.referenced) {
+            entry.referenced = false;
+            ++shard.hand;
+            continue;
+        }
+        ++shard.evictions;
+        erase_locked(shard, shard.hand);
+        return true;
+    }
+    return false;
+}
+
+QueryCache::Body QueryCache::find(const std::string& key) {
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        ++shard.misses;
+        return nullptr;
+    }
+    Entry& entry = shard.entries[it->second];
+    if (is_stale(entry, clock::now())) {
+        ++shard.stale;
+        ++shard.misses;
+        erase_locked(shard, it->second);
+        return nullptr;
+    }
+    entry.referenced = true;
+    ++shard.hits;
+    return entry.body;
+}
+
+void QueryCache::insert(const std::string& key, const std::string& table, uint64_t generation,
+    Body body, std::chrono::milliseconds ttl) {
+    if (!body || ttl.count() <= 0) return;
+    size_t bytes = key.size() + body->size() + sizeof(Entry);
+    if (bytes > max_entry_bytes_) return;
+    uint32_t slot = table_slot(table);
+    if (generations_[slot].load(std::memory_order_acquire) != generation) return;   // 실행 중 write 발생
+
+    auto now = clock::now();
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        erase_locked(shard, it->second);   // 같은 쿼리를 동시에 채운 경우 → 최신 결과로 교체
+    }
+    while (shard.bytes + bytes > shard_budget_ && evict_one_locked(shard, now)) {
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.body = std::move(body);
+    entry.table_slot = slot;
+    entry.generation = generation;
+    entry.expires = now + ttl;
+    entry.bytes = bytes;
+    shard.index.emplace(entry.key, shard.entries.size());
+    shard.entries.push_back(std::move(entry));
+    shard.bytes += bytes;
+}
+
+QueryCache::Stats QueryCache::stats() {
+    Stats st;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        st.hits += shard.hits;
+        st.misses += shard.misses;
+        st.stale += shard.stale;
+        st.evictions += shard.evictions;
+        st.entries += shard.entries.size();
+        st.bytes += shard.bytes;
+    }
+    st.invalidations = invalidations_.load(std::memory_order_relaxed);
+    st.max_bytes = shard_budget_ * shards_.size();
+    return st;
+}
+
+void invalidate_cached_table(const std::string& table) {
+    if (auto& cache = AppContext::instance().query_cache) {
+        cache->invalidate_table(table);
+    }
+}
@@ -0,0 +1,93 @@
+﻿#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 조회 결과 캐시 (select 응답 본문을 세션 포맷으로 인코딩된 그대로 보관)
+// - key: 포맷 + 정규화된 쿼리 모양 + 바인딩 값 (호출자가 만듦)
+// - shard 마다 mutex + CLOCK(second chance) 교체, shard 별 메모리 한도 = 전체 / shard 수
+// - 항목별 TTL, 만료 항목은 조회/교체 시 만나면 그 자리에서 회수 (전체 스캔 없음)
+// - 테이블 무효화: 테이블 이름 해시 slot 마다 generation 카운터
+//   write 가 끝나면 generation++ → 이전 generation 으로 저장된 결과는 조회 시 miss (lazy 삭제)
+//   slot 이 겹치는 다른 테이블도 같이 무효화되지만 결과가 틀리지는 않음
+class QueryCache {
+public:
+    using clock = std::chrono::steady_clock;
+    using Body = std::shared_ptr<const std::string>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stale = 0;          // 만료/무효화된 항목을 만나서 버린 횟수
+        uint64_t evictions = 0;      // 메모리 한도로 밀려난 항목
+        uint64_t invalidations = 0;  // invalidate_table 호출 수
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t max_bytes = 0;
+    };
+
+    QueryCache(size_t shard_count, size_t max_bytes);
+
+    QueryCache(const QueryCache&) = delete;
+    QueryCache& operator=(const QueryCache&) = delete;
+
+    // 살아 있는 항목이면 본문, 아니면 nullptr
+    Body find(const std::string& key);
+
+    // generation: 쿼리 실행 "전에" table_generation() 으로 읽은 값
+    // (실행 도중 같은 테이블에 write 가 끝났으면 저장하지 않음)
+    void insert(const std::string& key, const std::string& table, uint64_t generation,
+        Body body, std::chrono::milliseconds ttl);
+
+    uint64_t table_generation(const std::string& table) const;
+    void invalidate_table(const std::string& table);   // write 완료(커밋) 후 호출, 락 없음
+
+    Stats stats();
+
+private:
+    static constexpr size_t kGenerationSlots = 1024;
+
+    struct Entry {
+        std::string key;
+        Body body;
+        uint32_t table_slot = 0;
+        uint64_t generation = 0;
+        clock::time_point expires;
+        size_t bytes = 0;
+        bool referenced = false;     // CLOCK 참조 비트 (hit 시 set, hand 가 지나가며 clear)
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;                      // CLOCK 순환 대상
+        std::unordered_map<std::string, size_t> index;   // key → entries 위치
+        size_t hand = 0;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stale = 0;
+        uint64_t evictions = 0;
+    };
+
+    static uint32_t table_slot(const std::string& table);
+    Shard& shard_for(const std::string& key);
+    bool is_stale(const Entry& entry, clock::time_point now) const;
+    void erase_locked(Shard& shard, size_t pos);
+    bool evict_one_locked(Shard& shard, clock::time_point now);
+
+    std::vector<Shard> shards_;
+    size_t shard_budget_ = 0;        // shard 별 메모리 한도 (bytes)
+    size_t max_entry_bytes_ = 0;     // 이보다 큰 결과는 캐시하지 않음 (한 항목이 shard 를 비우지 않게)
+    std::array<std::atomic<uint64_t>, kGenerationSlots> generations_{};
+    std::atomic<uint64_t> invalidations_{ 0 };
+};
+
+// 테이블에 write 를 실행한 곳에서 호출 (캐시가 꺼져 있으면 아무것도 안 함)
+void invalidate_cached_table(const std::string& table);
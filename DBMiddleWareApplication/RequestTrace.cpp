@@ -0,0 +1,101 @@
+﻿#include "RequestTrace.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "Config.h"
+#include "Metrics.h"
+
+namespace tracing {
+
+namespace {
+    // 최근 느린 요청 N개 (가득 차면 가장 오래된 것부터 덮어씀)
+    // 느린 요청만 들어오므로 락 경합은 거의 없음
+    struct SlowRing {
+        std::mutex mutex;
+        std::vector<RequestTrace> entries;   // capacity 는 첫 사용 시 config 로 고정
+        size_t next = 0;
+    };
+
+    SlowRing& slow_ring() {
+        static SlowRing ring;
+        return ring;
+    }
+
+    int64_t elapsed_us(RequestTrace::clock::time_point from, RequestTrace::clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    }
+}
+
+void finish(const RequestTrace& trace) {
+    if (!trace) return;
+
+    // 1. 찍힌 단계끼리 구간 시간 (빠진 단계는 건너뛰고 직전 단계부터)
+    auto prev = trace.at[static_cast<size_t>(TraceStage::Read)];
+    for (size_t i = static_cast<size_t>(TraceStage::Read) + 1; i < kTraceStageCount; ++i) {
+        auto stage = static_cast<TraceStage>(i);
+        if (!trace.reached(stage)) continue;
+        metrics::observe_stage(stage, trace.at[i] - prev);
+        prev = trace.at[i];
+    }
+    auto total = prev - trace.at[static_cast<size_t>(TraceStage::Read)];
+    metrics::observe_stage(TraceStage::Read, total);
+
+    // 2. 느린 요청 샘플
+    auto config = current_config();
+    if (config->trace_slow_threshold.count() <= 0 || total < config->trace_slow_threshold) return;
+    metrics::add(metrics::Counter::SlowRequests);
+
+    auto& ring = slow_ring();
+    std::lock_guard<std::mutex> lock(ring.mutex);
+    if (ring.entries.capacity() == 0) {
+        ring.entries.reserve(std::max<size_t>(1, config->trace_slow_ring_size));
+    }
+    if (ring.entries.size() < ring.entries.capacity()) {
+        ring.entries.push_back(trace);
+    }
+    else {
+        ring.entries[ring.next] = trace;
+    }
+    ring.next = (ring.next + 1) % ring.entries.capacity();
+}
+
+std::string dump_slow_requests() {
+    std::vector<RequestTrace> entries;
+    size_t next = 0;
+    {
+        auto& ring = slow_ring();
+        std::lock_guard<std::mutex> lock(ring.mutex);
+        entries = ring.entries;
+        next = ring.next;
+    }
+
+    // 최근 것부터: next 바로 앞이 가장 최근
+    auto now = RequestTrace::clock::now();
+    nlohmann::json out = nlohmann::json::array();
+    for (size_t n = 0; n < entries.size(); ++n) {
+        const RequestTrace& trace = entries[(next + entries.size() - 1 - n) % entries.size()];
+        auto read_at = trace.at[static_cast<size_t>(TraceStage::Read)];
+
+        nlohmann::json stages = nlohmann::json::object();
+        auto prev = read_at;
+        for (size_t i = static_cast<size_t>(TraceStage::Read) + 1; i < kTraceStageCount; ++i) {
+            auto stage = static_cast<TraceStage>(i);
+            if (!trace.reached(stage)) continue;
+            stages[std::string(trace_stage_name(stage))] = elapsed_us(prev, trace.at[i]);
+            prev = trace.at[i];
+        }
+
+        auto type = message_type_name(trace.type);
+        nlohmann::json item;
+        item["session_id"] = trace.session_id;
+        item["type"] = type.empty() ? "other" : std::string(type);
+        item["total_us"] = elapsed_us(read_at, prev);
+        item["stages_us"] = std::move(stages);
+        item["age_ms"] = elapsed_us(read_at, now) / 1000;
+        out.push_back(std::move(item));
+    }
+    return out.dump();
+}
+
+}
@@ -0,0 +1,67 @@
+﻿#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "MessageType.h"
+
+// 요청 1건이 거친 단계별 시각 (steady_clock)
+// - 값으로 복사해서 들고 다님 (할당 없음): 수신 → dispatch → DB 완료 콜백 → write 큐
+// - 찍히지 않은 단계는 epoch(0) 그대로 (DB 를 안 거친 요청 등)
+enum class TraceStage : uint8_t {
+    Read,       // do_read 완료 (같은 read 로 들어온 프레임은 같은 시각)
+    Frame,      // extract_message 로 프레임 분리
+    Dispatch,   // secret 확인 + type 판별 끝, 핸들러 진입
+    Parse,      // 핸들러가 JSON DOM 을 만듦 (IncomingMessage::json 첫 호출, DOM 이 필요 없는 요청은 없음)
+    DbStart,    // DB 워커가 커넥션을 잡고 쿼리 시작
+    DbEnd,      // 쿼리 완료
+    Write,      // 응답 async_write 완료
+    Count
+};
+constexpr size_t kTraceStageCount = static_cast<size_t>(TraceStage::Count);
+
+// 구간 이름: 직전에 찍힌 단계 → 이 단계까지 걸린 시간
+// (Read 자리는 구간이 없으므로 전체 Read → 마지막 단계를 "total" 로 사용)
+inline constexpr std::array<std::string_view, kTraceStageCount> kTraceStageNames{
+    "total",     // Read
+    "frame",     // Read → Frame     : 같은 read 의 앞 프레임 처리 대기 포함
+    "dispatch",  // Frame → Dispatch : secret 비교 + type 스캔 (MessagePack/CBOR 는 여기서 전체 decode)
+    "parse",     // Dispatch → Parse : JSON DOM 생성
+    "db_wait",   // 직전 단계 → DbStart : 핸들러 + 배칭 window + DB 큐 + 커넥션 획득
+    "db",        // DbStart → DbEnd
+    "write",     // 직전 단계 → Write : strand 복귀 + write_queue 대기 + 소켓 write
+};
+
+constexpr std::string_view trace_stage_name(TraceStage stage) {
+    return kTraceStageNames[static_cast<size_t>(stage)];
+}
+
+struct RequestTrace {
+    using clock = std::chrono::steady_clock;
+
+    std::array<clock::time_point, kTraceStageCount> at{};
+    int session_id = 0;
+    MessageType type = MessageType::Unknown;
+
+    // Read 가 찍힌 trace 만 유효 (trace_enabled 가 꺼져 있으면 빈 trace 가 돌아다님)
+    explicit operator bool() const { return reached(TraceStage::Read); }
+
+    bool reached(TraceStage stage) const {
+        return at[static_cast<size_t>(stage)].time_since_epoch().count() != 0;
+    }
+    void mark(TraceStage stage) { at[static_cast<size_t>(stage)] = clock::now(); }
+    void set(TraceStage stage, clock::time_point time) { at[static_cast<size_t>(stage)] = time; }
+};
+
+namespace tracing {
+
+// 끝난 요청 기록: 단계별 히스토그램(metrics) + 임계치 이상이면 slow ring buffer 에 샘플
+// 빈 trace 는 무시. 어느 스레드에서든 호출 가능 (ring buffer 는 느린 요청일 때만 잠금)
+void finish(const RequestTrace& trace);
+
+// slow ring buffer 덤프 (최근 것부터, JSON 배열)
+std::string dump_slow_requests();
+
+}
@@ -0,0 +1,235 @@
+﻿#include "SelectStream.h"
+#include <atomic>
+#include <stdexcept>
+#include "AppContext.h"
+#include "Logger.h"
+#include "DbExecutor.h"
+#include "MysqlPool.h"
+#include "Session.h"
+#include "Metrics.h"
+
+namespace {
+    // 동시에 도는 select_stream 수 (스트림은 끝날 때까지 DB 커넥션 1개를 점유)
+    std::atomic<size_t> g_active_streams{ 0 };
+
+    // 청크 경계 판단용 대략적인 인코딩 크기 (dump 하지 않음, 한도 보장은 post_rows 가 실제 크기로)
+    size_t estimate_encoded_size(const nlohmann::json& values) {
+        size_t bytes = 2;
+        for (const auto& v : values) {
+            bytes += v.is_string() ? v.get_ref<const std::string&>().size() + 3 : 9;
+        }
+        return bytes;
+    }
+}
+
+SelectStream::StartResult SelectStream::start(const std::shared_ptr<DbExecutor>& executor, std::shared_ptr<Session> session,
+    SelectStreamRequest request, const Limits& limits, RequestTrace trace) {
+    if (g_active_streams.fetch_add(1) >= limits.max_concurrent) {
+        g_active_streams.fetch_sub(1);
+        return StartResult::TooManyStreams;
+    }
+    // 여기서 올린 카운트는 스트림 객체 소멸 때 내림 (큐 등록 실패로 바로 해제돼도 마찬가지)
+    auto stream = std::make_shared<SelectStream>(executor, std::move(session), std::move(request), limits, std::move(trace));
+    bool queued = executor->submit_lease([stream](std::unique_ptr<DbConnection> conn) {
+        stream->open(std::move(conn));
+    });
+    return queued ? StartResult::Started : StartResult::QueueFull;
+}
+
+SelectStream::SelectStream(std::shared_ptr<DbExecutor> executor, std::shared_ptr<Session> session,
+    SelectStreamRequest request, const Limits& limits, RequestTrace trace)
+    : executor_(std::move(executor)),
+    session_(std::move(session)),
+    request_(std::move(request)),
+    limits_(limits),
+    trace_(std::move(trace)),
+    format_(session_->get_wire_format())
+{
+}
+
+SelectStream::~SelectStream() {
+    release_connection(!result_ || exhausted_);   // 중간에 버려진 스트림 (executor 정지 등)
+    g_active_streams.fetch_sub(1);
+}
+
+void SelectStream::open(std::unique_ptr<DbConnection> conn) {
+    if (!conn) {
+        abort("DB connection unavailable");
+        return;
+    }
+    conn_ = std::move(conn);
+    trace_.mark(TraceStage::DbStart);
+    try {
+        result_.emplace(conn_->execute(make_select_shape_key(request_.table, request_.columns, request_.where_columns),
+            [&]() { return build_select_shape(request_.table, request_.columns, request_.where_columns); },
+            request_.params));
+        names_ = result_column_names(*result_);
+    }
+    catch (const mysqlx::Error& e) {
+        conn_->mark_suspect();
+        abort(e.what());
+        return;
+    }
+    catch (const std::exception& e) {
+        abort(e.what());
+        return;
+    }
+    produce();
+}
+
+void SelectStream::produce() {
+    try {
+        while (!exhausted_) {
+            if (session_->is_closed()) {
+                abort("session closed");
+                return;
+            }
+            if (rows_.size() >= limits_.chunk_rows || chunk_bytes_ >= limits_.chunk_bytes) {
+                if (!send_chunk()) return;
+                continue;
+            }
+            mysqlx::Row row = result_->fetchOne();
+            if (!row) {
+                exhausted_ = true;
+                break;
+            }
+            nlohmann::json values = row_to_json(row);
+            chunk_bytes_ += estimate_encoded_size(values);
+            rows_.push_back(std::move(values));
+            ++total_rows_;
+        }
+        // 마지막 청크 (빈 결과여도 columns 를 담은 청크 1개는 보냄)
+        if (!rows_.empty() || chunks_ == 0) {
+            if (!send_chunk()) return;
+        }
+        finish();
+    }
+    catch (const mysqlx::Error& e) {
+        conn_->mark_suspect();   // fetchOne 도중 끊긴 경우 등
+        abort(e.what());
+    }
+    catch (const std::exception& e) {
+        abort(e.what());
+    }
+}
+
+bool SelectStream::send_chunk() {
+    if (session_->pending_writes() >= limits_.high_water) {
+        suspend();
+        return false;
+    }
+    post_rows(std::move(rows_));
+    rows_ = nlohmann::json::array();
+    chunk_bytes_ = 0;
+    return true;
+}
+
+// 실제 인코딩 크기가 max_packet_bytes 를 넘으면 행을 반으로 나눠 각각 다시 (seq 는 실제로 보낸 청크 기준)
+// 1행만으로도 넘치면 클라이언트가 받을 수 없으므로 스트림 중단
+void SelectStream::post_rows(nlohmann::json rows) {
+    nlohmann::json chunk;
+    chunk["type"] = "rows_chunk";
+    chunk["stream_id"] = request_.stream_id;
+    chunk["seq"] = chunks_;
+    if (chunks_ == 0) chunk["columns"] = names_;
+    chunk["rows"] = std::move(rows);
+    OutboundRef msg = encode_message(format_, chunk);
+
+    if (msg.size() > limits_.max_packet_bytes) {
+        auto& all = chunk["rows"];
+        if (all.size() <= 1) {
+            throw std::length_error("row exceeds max_outbound_packet_size");
+        }
+        metrics::add(metrics::Counter::StreamChunkSplits);
+        size_t half = all.size() / 2;
+        nlohmann::json head = nlohmann::json::array();
+        nlohmann::json tail = nlohmann::json::array();
+        for (size_t i = 0; i < all.size(); ++i) {
+            (i < half ? head : tail).push_back(std::move(all[i]));
+        }
+        post_rows(std::move(head));
+        post_rows(std::move(tail));
+        return;
+    }
+
+    session_->post_write(std::move(msg));
+    metrics::add(metrics::Counter::StreamChunks);
+    ++chunks_;
+}
+
+// 송신 대기가 찼음 → 이 워커 작업은 여기서 끝내고, 세션 write 완료(strand)에서 다시 워커로 이어감
+// 콜백이 등록 직후 바로 불릴 수 있으므로 이 함수 뒤에는 상태를 건드리지 않음
+void SelectStream::suspend() {
+    metrics::add(metrics::Counter::StreamBackpressureWaits);
+    auto self = shared_from_this();
+    session_->when_write_room(limits_.high_water, limits_.stall_timeout, [self](bool has_room) {
+        // 결과 읽기 / 커넥션 정리는 블로킹이라 네트워크 스레드가 아니라 워커에서
+        bool queued = self->executor_->submit_continuation([self, has_room]() {
+            if (has_room) {
+                self->produce();
+            }
+            else {
+                self->abort(self->session_->is_closed() ? "session closed" : "client too slow");
+            }
+        });
+        if (!queued) {
+            LOG_SAMPLED(LogCategory::Db, spdlog::level::warn, "[select_stream] DB executor stopped, dropping stream session_id={}",
+                self->session_->get_session_id());
+        }
+    });
+}
+
+void SelectStream::finish() {
+    trace_.mark(TraceStage::DbEnd);
+    release_connection(true);
+    if (session_->is_closed()) return;
+
+    nlohmann::json end;
+    end["type"] = "rows_end";
+    end["stream_id"] = request_.stream_id;
+    if (request_.request_id) end[std::string(kRequestIdField)] = *request_.request_id;
+    end["result"] = "ok";
+    end["rows"] = total_rows_;
+    end["chunks"] = chunks_;
+    session_->post_write(encode_message(format_, end), trace_);
+}
+
+void SelectStream::abort(const std::string& reason) {
+    if (trace_.reached(TraceStage::DbStart)) trace_.mark(TraceStage::DbEnd);
+    metrics::add(metrics::Counter::StreamAborts);
+    LOG_SAMPLED(LogCategory::Db, spdlog::level::warn, "[select_stream] aborted: session_id={}, table={}, rows={}, reason={}",
+        session_->get_session_id(), request_.table, total_rows_, reason);
+
+    release_connection(!result_ || exhausted_);
+    if (session_->is_closed()) return;
+
+    nlohmann::json end;
+    end["type"] = "rows_end";
+    end["stream_id"] = request_.stream_id;
+    if (request_.request_id) end[std::string(kRequestIdField)] = *request_.request_id;
+    end["result"] = "fail";
+    end["msg"] = reason;
+    session_->post_write(encode_message(format_, end), trace_);
+}
+
+// clean = 결과를 끝까지 읽었거나 결과가 없음 → 풀에 반납 (suspect 면 ping)
+// 아니면 남은 행을 읽지 않고 커넥션째 폐기: 결과 객체를 해제하기 전에 세션을 먼저 닫아야
+// 해제 때 나머지 행을 서버에서 끝까지 받아 버리는 일이 없음
+void SelectStream::release_connection(bool clean) {
+    if (!conn_) return;
+    if (!clean) {
+        try {
+            conn_->session().close();
+        }
+        catch (const std::exception& e) {
+            LOG_SAMPLED(LogCategory::Db, spdlog::level::warn, "[select_stream] close error while discarding connection: {}", e.what());
+        }
+    }
+    result_.reset();
+    if (clean) {
+        executor_->return_connection(std::move(conn_));
+    }
+    else {
+        executor_->discard_connection(std::move(conn_));
+    }
+}
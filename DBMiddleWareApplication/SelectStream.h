@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "RequestTrace.h"
+#include "WireFormat.h"
+
+// MySQL Connector/C++ 8.x (X DevAPI)
+#include <mysqlx/xdevapi.h>
+
+class Session;
+class DbExecutor;
+class DbConnection;
+
+// select_stream 요청 1건 (식별자 검사 / where bind 는 dispatcher 에서 끝난 상태)
+struct SelectStreamRequest {
+    int64_t stream_id = 0;
+    std::optional<int64_t> request_id;          // 요청의 req_id (rows_end 에 그대로)
+    std::string table;
+    std::vector<std::string> columns;           // 비면 *
+    std::vector<std::string> where_columns;
+    std::vector<mysqlx::Value> params;          // where 값 + limit
+};
+
+// select_stream 1개의 생산자 (DB 워커 작업 여러 번에 걸쳐 이어짐)
+// - 커넥션과 결과 객체를 스트림이 직접 소유 (DbExecutor::submit_lease)
+// - 세션 송신 대기가 high water 이상이면 워커를 놓고 세션 write 완료 경로의 콜백에서 다시 워커로 이어감
+//   → 느린 클라이언트가 DB 워커를 붙잡지 않음 (붙잡는 것은 커넥션 1개뿐, stream_max_concurrent 로 제한)
+// - 끝까지 읽으면 커넥션 반납, 중간에 멈추면(세션 종료 / stall timeout / 오류) 남은 행을 읽지 않고 커넥션째 폐기
+class SelectStream : public std::enable_shared_from_this<SelectStream> {
+public:
+    struct Limits {
+        size_t chunk_rows = 500;
+        size_t chunk_bytes = 32768;               // 청크 경계 (행 크기 어림값 기준)
+        size_t max_packet_bytes = 65536;          // 실제 인코딩 크기 한도 (넘으면 청크를 나눔)
+        size_t high_water = 8;
+        std::chrono::milliseconds stall_timeout{ 30000 };
+        size_t max_concurrent = 4;
+    };
+
+    enum class StartResult { Started, TooManyStreams, QueueFull };
+
+    // 동시 스트림 한도 확인 후 첫 워커 작업(쿼리 실행) 등록. Started 가 아니면 호출자가 busy 응답
+    static StartResult start(const std::shared_ptr<DbExecutor>& executor, std::shared_ptr<Session> session,
+        SelectStreamRequest request, const Limits& limits, RequestTrace trace);
+
+    SelectStream(std::shared_ptr<DbExecutor> executor, std::shared_ptr<Session> session,
+        SelectStreamRequest request, const Limits& limits, RequestTrace trace);
+    ~SelectStream();
+
+    // 복사/이동 금지
+    SelectStream(const SelectStream&) = delete;
+    SelectStream& operator=(const SelectStream&) = delete;
+
+private:
+    void open(std::unique_ptr<DbConnection> conn);   // 워커: 쿼리 실행 후 생산 시작
+    void produce();                                  // 워커: 결과를 끝까지 또는 송신 대기가 찰 때까지 청크로 보냄
+    bool send_chunk();                               // false = 송신 대기가 차서 멈춤 (write 완료 때 재개)
+    void post_rows(nlohmann::json rows);             // rows_chunk 인코딩 + post (한도를 넘으면 나눠서)
+    void suspend();
+    void finish();                                   // 정상 종료: rows_end ok + 커넥션 반납
+    void abort(const std::string& reason);           // 중단: rows_end fail + 커넥션 폐기
+    void release_connection(bool clean);
+
+private:
+    std::shared_ptr<DbExecutor> executor_;
+    std::shared_ptr<Session> session_;
+    SelectStreamRequest request_;
+    Limits limits_;
+    RequestTrace trace_;
+    WireFormat format_;
+
+    std::unique_ptr<DbConnection> conn_;
+    std::optional<mysqlx::SqlResult> result_;
+    nlohmann::json names_;
+    nlohmann::json rows_ = nlohmann::json::array();  // 보내기 전 청크
+    size_t chunk_bytes_ = 0;
+    uint64_t total_rows_ = 0;
+    uint64_t chunks_ = 0;
+    bool exhausted_ = false;                         // fetchOne 이 끝을 반환함 (커넥션을 그대로 반납해도 됨)
+};
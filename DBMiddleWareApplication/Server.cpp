@@ -5,48 +5,98 @@
 #include "Logger.h"
 #include "AllowedIPManager.h"
 #include "AppContext.h"
+#include "IoContextPool.h"
+#include "Metrics.h"
 
 using namespace std;
 using boost::asio::ip::tcp;
 using namespace boost::asio;
 
-Server::Server(boost::asio::io_context& io, short port, shared_ptr<DataHandler> data_handler)
-    : acceptor_(io, tcp::endpoint(tcp::v4(), port)), session_counter_(0), data_handler_(data_handler) {
+namespace {
+#if defined(SO_REUSEPORT)
+    // 같은 포트에 acceptor 여러 개 bind → 커널이 연결을 나눠줌 (Linux 3.9+, BSD)
+    using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+}
+
+Server::Server(IoContextPool& io_pool, short port, shared_ptr<DataHandler> data_handler, bool per_core)
+    : io_pool_(io_pool), per_core_(per_core), session_counter_(0), data_handler_(data_handler) {
     allowed_ip_mgr_.load("allowed_ips.txt"); // 서버 시작시 IP 화이트리스트 로딩
-    start_accept();
+
+    tcp::endpoint endpoint(tcp::v4(), port);
+#if defined(SO_REUSEPORT)
+    // per_core: io_context 마다 자기 acceptor → accept 부터 세션 종료까지 한 코어에서 처리
+    if (per_core_ && io_pool_.size() > 1) {
+        for (size_t i = 0; i < io_pool_.size(); ++i) {
+            auto acceptor = std::make_unique<tcp::acceptor>(io_pool_.get(i));
+            acceptor->open(endpoint.protocol());
+            acceptor->set_option(tcp::acceptor::reuse_address(true));
+            acceptor->set_option(reuse_port(true));
+            acceptor->bind(endpoint);
+            acceptor->listen();
+            acceptors_.push_back(std::move(acceptor));
+        }
+    }
+#endif
+    // shared 모드 또는 SO_REUSEPORT 없는 플랫폼(Windows): acceptor 1개가 받아서 코어별 io_context 로 분배
+    if (acceptors_.empty()) {
+        acceptors_.push_back(std::make_unique<tcp::acceptor>(io_pool_.get(0), endpoint));
+    }
+    AppContext::instance().logger->info("[Server] mode={}, io_contexts={}, acceptors={}",
+        per_core_ ? "per_core" : "shared", io_pool_.size(), acceptors_.size());
+
+    for (size_t i = 0; i < acceptors_.size(); ++i) {
+        start_accept(i);
+    }
+}
+
+void Server::start_accept(size_t index) {
+    // acceptor 가 여러 개면 자기 io_context 에, 1개면 round-robin 으로 고른 io_context 에 소켓 생성
+    boost::asio::io_context& peer_io = acceptors_.size() > 1 ? io_pool_.get(index) : io_pool_.next();
+    acceptors_[index]->async_accept(peer_io, [this, index](boost::system::error_code ec, tcp::socket socket) {
+        on_accept(ec, std::move(socket));
+        start_accept(index);
+        });
 }
 
-void Server::start_accept() {
-    acceptor_.async_accept([this](boost::system::error_code ec, tcp::socket socket) {
-        if (!ec) {
-            // 클라이언트 IP 추출
-            std::string client_ip = socket.remote_endpoint().address().to_string();
-            if (!allowed_ip_mgr_.is_allowed(client_ip)) {
-                AppContext::instance().logger->warn("차단된 IP로부터의 접속 시도: {}", client_ip);
-                socket.close(); // 즉시 연결 종료
+void Server::on_accept(boost::system::error_code ec, tcp::socket socket) {
+    if (!ec) {
+        metrics::add(metrics::Counter::Accepts);
+        // 클라이언트 IP 추출 (accept 직후 peer 가 끊었으면 실패 → 예외 없이 바로 닫음)
+        boost::system::error_code ep_ec;
+        auto remote = socket.remote_endpoint(ep_ec);
+        if (ep_ec) {
+            metrics::add(metrics::Counter::AcceptRejected);
+            LOG_SAMPLED(LogCategory::Net, spdlog::level::warn, "[Server] accept 직후 remote_endpoint 실패: {}", ep_ec.message());
+            socket.close(ep_ec);
+            return;
+        }
+        std::string client_ip = remote.address().to_string();
+        if (!allowed_ip_mgr_.is_allowed(client_ip)) {
+            metrics::add(metrics::Counter::AcceptRejected);
+            AppContext::instance().logger->warn("차단된 IP로부터의 접속 시도: {}", client_ip);
+            socket.close(); // 즉시 연결 종료
+        }
+        else {
+            int session_id = session_counter_.fetch_add(1);
+            auto session = make_shared<Session>(std::move(socket), session_id, data_handler_);
+            if (session) {
+                data_handler_->add_session(session_id, session);
+                // 미인증 세션 상한은 accept 마다 전체 순회하지 않고 모니터 루프에서 (max_unauth_sessions)
+                session->start();
+                std::cout << "New client connected, session ID: " << session_id << std::endl;
+                //LOG_INFO("New client connected, session ID: ", session_id);
+                AppContext::instance().logger->info("New client connected, session ID: {}", session_id);
+                // IP/포트 바로 출력!
+                AppContext::instance().logger->info("New client: session_id={}, IP={}, port={}", session_id, session->get_client_ip(), session->get_client_port());
             }
             else {
-                int session_id = session_counter_.fetch_add(1);
-                auto session = make_shared<Session>(std::move(socket), session_id, data_handler_);
-                if (session) {
-                    data_handler_->add_session(session_id, session);
-                    //data_handler_->cleanup_unauth_sessions(100); // 최대 미인증 세션 100개로 제한
-                    session->start();
-                    std::cout << "New client connected, session ID: " << session_id << std::endl;
-                    //LOG_INFO("New client connected, session ID: ", session_id);
-                    AppContext::instance().logger->info("New client connected, session ID: {}", session_id);
-                    // IP/포트 바로 출력!
-                    AppContext::instance().logger->info("New client: session_id={}, IP={}, port={}", session_id, session->get_client_ip(), session->get_client_port());
-                }
-                else {
-                    std::cerr << "[SESSION POOL] No free session available!" << std::endl;
-                    //LOG_ERROR("[SESSION POOL] No free session available!");
-                    AppContext::instance().logger->info("[SESSION POOL] No free session available!");
-
-                    // 연결 닫기 등 예외 처리
-                }
+                std::cerr << "[SESSION POOL] No free session available!" << std::endl;
+                //LOG_ERROR("[SESSION POOL] No free session available!");
+                AppContext::instance().logger->info("[SESSION POOL] No free session available!");
+
+                // 연결 닫기 등 예외 처리
             }
         }
-        start_accept();
-        });
+    }
 }
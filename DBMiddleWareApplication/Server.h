@@ -4,22 +4,29 @@
 #include <unordered_map>
 #include <memory>
 #include <atomic>
+#include <vector>
 #include "AllowedIPManager.h"
 
+class IoContextPool;
+
 class Server {
 private:
-    boost::asio::ip::tcp::acceptor acceptor_;
+    IoContextPool& io_pool_;
+    bool per_core_;
+    // shared 모드 / SO_REUSEPORT 미지원: 1개, per_core + SO_REUSEPORT: io_context 마다 1개
+    std::vector<std::unique_ptr<boost::asio::ip::tcp::acceptor>> acceptors_;
 
-    std::atomic<int> session_counter_;
+    std::atomic<int> session_counter_;   // 모든 acceptor 공용 (세션 ID 전역 유일)
     std::shared_ptr<DataHandler> data_handler_;
 
     AllowedIPManager allowed_ip_mgr_;
 
 public:
-    Server(boost::asio::io_context& io, short port, std::shared_ptr<DataHandler> data_handler);
+    Server(IoContextPool& io_pool, short port, std::shared_ptr<DataHandler> data_handler, bool per_core);
 
     void accept();
 
 private:
-    void start_accept();
-};
\ No newline at end of file
+    void start_accept(size_t index);
+    void on_accept(boost::system::error_code ec, boost::asio::ip::tcp::socket socket);
+};
@@ -5,9 +5,12 @@
 #include "Logger.h"
 #include <random>
 #include <sstream>
+#include <algorithm>
 #include "Utility.h"
 #include <nlohmann/json.hpp>
 #include "AppContext.h"
+#include "Config.h"
+#include "Metrics.h"
 
 using namespace std;
 using namespace boost::asio;
@@ -19,81 +22,80 @@ Session::Session(tcp::socket socket, int session_id, weak_ptr<DataHandler> data_
     session_id_(session_id),
     data_handler_(data_handler),
     strand_(boost::asio::make_strand(socket_.get_executor())),
-    login_timer_(strand_),
-    retry_timer_(strand_) {
+    wheel_(&timer_wheel(boost::asio::query(socket_.get_executor(), boost::asio::execution::context))) {
     // Session에서 각자 keepalive 타이머를 관리 하는 방식
     //ping_timer_(socket_.get_executor()),
     //keepalive_timer_(socket_.get_executor()) {
-    memset(data_, 0, sizeof(data_));
+    auto config = current_config();
+
+    // 수신 버퍼: 초기 크기에서 시작해서 트래픽에 맞춰 min~max 사이로 조정
+    recv_chunk_ = config->recv_buffer_initial;
+    apply_limits(*config);
+    msg_buf_mgr_.shrink_to(recv_chunk_);
+    write_bufs_.reserve(write_batch_max_msgs_);
+
     // 글로벌 구조에서는 세션 생성시점에 마지막 pong 시간 초기화!
     last_alive_time_ = std::chrono::steady_clock::now();
 
-    auto& exec = socket_.get_executor();
-    AppContext::instance().logger->info("[DEBUG] Executor 사용 중인 io_context 주소: {}", (void*)&exec.context());
+    LOG_DEBUG("[DEBUG] Executor 사용 중인 io_context 주소: {}",
+        (void*)&boost::asio::query(socket_.get_executor(), boost::asio::execution::context));
 
-    AppContext::instance().logger->info("[DEBUG] Session 생성자 완료: session_id={}, strand_ is running={}",
+    LOG_DEBUG("[DEBUG] Session 생성자 완료: session_id={}, strand_ is running={}",
         session_id_, strand_.running_in_this_thread());
 }
 
 Session::~Session() {
     //cerr << "[세션 소멸] id=" << session_id_ << endl;  
     //LOG_ERROR("[세션 소멸] id=", session_id_);
-    AppContext::instance().logger->error("[세션 소멸] id= {}", session_id_);
+    LOG_SAMPLED(LogCategory::Session, spdlog::level::info, "[세션 소멸] id= {}", session_id_);
+    flush_recv_stats();
 }
 
 void Session::start() {
-    AppContext::instance().logger->info("[TRACK] Session::start() 진입, session_id={}", session_id_);
+    LOG_TRACK("[TRACK] Session::start() 진입, session_id={}", session_id_);
     do_read();
     start_login_timeout();    // 타이머 시작 추가!
+    if (current_config()->idle_timeout.count() > 0) {
+        schedule_idle_check(current_config()->idle_timeout);
+    }
 }
 
 int Session::get_session_id() const {
     return session_id_;
 }
 
-void Session::post_task(std::function<void()> fn) {
-    AppContext::instance().logger->info("[TRACK] post_task() 호출됨, session_id={}", session_id_);
-    auto self = shared_from_this();
-    //std::cout << "[DEBUG] post_task called (session_id=" << session_id_ << ")" << std::endl;
-    boost::asio::dispatch(strand_, [this, self, fn = std::move(fn)]() mutable {
-        //std::cout << "[DEBUG] task enqueued" << std::endl;
-        AppContext::instance().logger->info("[DEBUG] strand 내부 진입: session_id={}", session_id_);
-        if (task_queue_.size() >= static_cast<size_t>(AppContext::instance().config.value("max_task_queue", 1000))) {
-            //std::cerr << "[WARN] task_queue_ overflow! (session_id=" << session_id_ << ")\n";
-            //LOG_WARN("[WARN] task_queue_ overflow! (session_id=", session_id_);
-            AppContext::instance().logger->warn("[WARN] task_queue_ overflow! (session_id= {}", session_id_);
-            close_session();  // 또는 에러 메시지, 혹은 그냥 무시
-            return;
-        }
-        task_queue_.push(std::move(fn));
-        if (!task_running_) {
-            task_running_ = true;
-            run_next_task();
-        }
-        });
-}
-
-void Session::run_next_task() {
-    //std::cout << "[DEBUG] run_next_task()" << std::endl;
-    if (task_queue_.empty()) {
-        task_running_ = false;
+// (1) post_write(JSON 텍스트용): Json 세션은 slab 버퍼에 프리픽스와 함께 복사, msgpack/cbor 세션은 파싱 후 세션 포맷으로 인코딩
+void Session::post_write(const std::string& json_text) {
+    WireFormat format = get_wire_format();
+    if (format == WireFormat::Json) {
+        post_write(OutboundRef::make(json_text));
         return;
     }
-    auto fn = std::move(task_queue_.front());
-    task_queue_.pop();
-    //std::cout << "[DEBUG] running fn()" << std::endl;
-    fn();  // 비동기 작업 진입, 콜백 마지막에 run_next_task() 호출!
+    try {
+        post_write(encode_message(format, nlohmann::json::parse(json_text)));
+    }
+    catch (const nlohmann::json::exception& e) {
+        LOG_SAMPLED(LogCategory::Session, spdlog::level::warn, "[post_write] JSON 이 아닌 텍스트는 {} 세션에 보낼 수 없음 session_id={}, err={}",
+            wire_format_name(format), session_id_, e.what());
+    }
 }
 
-// (1) post_write(기존 string용 → shared_ptr 버전으로 변환해서 호출)
-void Session::post_write(const std::string& msg) {
-    post_write(std::make_shared<std::string>(msg));
+// (2) post_write(OutboundRef 버전, 핵심 로직)
+// msg 는 move 로만 strand 에 넘김 → 참조 카운트는 strand 안에서만 변함
+void Session::post_write(OutboundRef msg) {
+    post_write(std::move(msg), RequestTrace{});
 }
 
-// (2) post_write(shared_ptr 버전, 핵심 로직)
-void Session::post_write(const std::shared_ptr<std::string> msg) {
+// (3) trace 를 같이 넘기는 버전 (빈 trace 면 지금 dispatch 중인 요청의 trace 를 가져감)
+void Session::post_write(OutboundRef msg, const RequestTrace& request_trace) {
     auto self = shared_from_this();
-    boost::asio::dispatch(strand_, [this, self, msg]() {
+    pending_writes_.fetch_add(1);   // strand 에 들어가기 전부터 셈 (다른 스레드 생산자가 앞질러 쌓지 않게)
+    WireFormat format = get_wire_format();   // 호출자가 인코딩한 시점의 포맷 (hello_ack 는 전환 전 포맷)
+    boost::asio::dispatch(strand_, [this, self, msg = std::move(msg), trace = request_trace, format]() mutable {
+        // dispatch 안에서 바로 보낸 응답 → 그 요청의 첫 응답에 trace 를 붙임
+        if (!trace && current_trace_) {
+            trace = take_trace();
+        }
 		// 기존 write_queue_ 사이즈 초과시 무조건 close 하던거 삭제 enqueue_write 에서 처리 
         //if (write_queue_.size() >= MAX_WRITE_QUEUE) {
         //    std::cerr << "[WARN] write_queue_ overflow! (session_id=" << session_id_ << ")\n";
@@ -102,7 +104,7 @@ void Session::post_write(const std::shared_ptr<std::string> msg) {
         //}  
         bool idle = write_queue_.empty();
         //write_queue_.push(msg);
-        enqueue_write(msg);
+        enqueue_write(std::move(msg), trace, format);
         if (idle) {
             write_in_progress_ = true;
             do_write_queue();
@@ -117,28 +119,47 @@ void Session::do_write_queue() {
         write_in_progress_ = false;
         return;
     }
-    auto msg = write_queue_.front();
     uint64_t my_generation = generation_.load(std::memory_order_relaxed); // 세대 캡처
 
-    // === 길이 프리픽스 만들기 ===
-    uint32_t len = static_cast<uint32_t>(msg->size());
-    uint32_t len_net = htonl(len); // 네트워크 바이트 오더(빅엔디안)
-    std::array<char, 4> len_buf;
-    memcpy(len_buf.data(), &len_net, 4);
-
-    // === 버퍼 합치기 ===
-    std::vector<boost::asio::const_buffer> buffers;
-    buffers.push_back(boost::asio::buffer(len_buf));
-    buffers.push_back(boost::asio::buffer(*msg));
+    // === 큐 앞쪽에서 최대 N개 / M바이트를 모아 한 번의 scatter/gather write 로 ===
+    size_t batch = std::min(write_queue_.size(), write_batch_max_msgs_);
+    write_bufs_.clear();
+    size_t count = 0;
+    size_t bytes = 0;
+    std::array<uint64_t, kWireFormatCount> format_msgs{};
+    std::array<uint64_t, kWireFormatCount> format_bytes{};
+    for (const auto& queued : write_queue_) {
+        const OutboundRef& msg = queued.msg;
+        if (count >= batch) break;
+        if (count > 0 && bytes + msg.wire_size() > write_batch_max_bytes_) break;
+
+        // 길이 프리픽스는 버퍼 생성 시 이미 채워져 있음 → 메시지당 버퍼 1개
+        write_bufs_.push_back(boost::asio::buffer(msg.wire_data(), msg.wire_size()));
+        bytes += msg.wire_size();
+        ++count;
+        ++format_msgs[static_cast<size_t>(queued.format)];
+        format_bytes[static_cast<size_t>(queued.format)] += msg.size();
+    }
+    write_in_flight_ = count;
+
+    auto& stats = send_stats();
+    stats.writes.fetch_add(1, std::memory_order_relaxed);
+    stats.messages.fetch_add(count, std::memory_order_relaxed);
+    stats.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    for (size_t i = 0; i < kWireFormatCount; ++i) {   // 메시지가 인코딩된 포맷 기준 (보통 한 포맷만)
+        if (!format_msgs[i]) continue;
+        auto& format_stats = wire_format_stats(static_cast<WireFormat>(i));
+        format_stats.messages_out.fetch_add(format_msgs[i], std::memory_order_relaxed);
+        format_stats.bytes_out.fetch_add(format_bytes[i], std::memory_order_relaxed);
+    }
 
-    //boost::asio::async_write(socket_, boost::asio::buffer(*msg),
-    boost::asio::async_write(socket_, buffers,      // 4바이트 프리픽스로 변경
+    boost::asio::async_write(socket_, write_bufs_,      // (4바이트 프리픽스 + 본문) 여러 개
         boost::asio::bind_executor(strand_,
             [this, self, my_generation](const boost::system::error_code& ec, std::size_t /*length*/) {
                 try {
                     // === generation check ===
                     if (my_generation != generation_.load(std::memory_order_relaxed)) {
-                        AppContext::instance().logger->warn("[do_write_queue] Stale write callback (세대 mismatch)! 세션ID={} 무시", get_session_id());
+                        LOG_SAMPLED(LogCategory::Net, spdlog::level::warn, "[do_write_queue] Stale write callback (세대 mismatch)! 세션ID={} 무시", get_session_id());
                         return;
                     }
 
@@ -148,7 +169,16 @@ void Session::do_write_queue() {
                         close_session();
                         return;
                     }
-                    write_queue_.pop();
+                    // 이번 write 로 나간 응답의 요청 trace 마감
+                    for (size_t i = 0; i < write_in_flight_; ++i) {
+                        auto& trace = write_queue_[i].trace;
+                        if (!trace) continue;
+                        trace.mark(TraceStage::Write);
+                        tracing::finish(trace);
+                    }
+                    write_queue_.erase(write_queue_.begin(), write_queue_.begin() + write_in_flight_);   // 버퍼는 여기서 slab 으로 반납
+                    release_pending_writes(write_in_flight_);
+                    write_in_flight_ = 0;
                     do_write_queue();
                 }
                 catch (const std::exception& e) {
@@ -161,27 +191,64 @@ void Session::do_write_queue() {
     );
 }
 
+SendStats& Session::send_stats() {
+    static SendStats stats;
+    return stats;
+}
+
 void Session::start_login_timeout() {
     if (get_state() == SessionState::Closed) {
-        AppContext::instance().logger->warn("Closed session: Callback/Ignore Message [session_id={}]", get_session_id());
+        LOG_SAMPLED(LogCategory::Session, spdlog::level::warn, "Closed session: Callback/Ignore Message [session_id={}]", get_session_id());
         return;
     }
-    login_timer_.expires_after(std::chrono::seconds(AppContext::instance().config.value("login_timeout_seconds", 90))); // 예: 90초
-    auto self = shared_from_this();
-    login_timer_.async_wait([this, self](const boost::system::error_code& ec) {
-        if (!ec && !nickname_registered_) {
-            std::cerr << "[LOGIN TIMEOUT] session_id=" << session_id_ << " Login timed out, session ended!" << std::endl;
-            post_write(R"({"type":"notice","msg":"Your connection has been terminated due to a login timeout."})" "\n");
+    // 휠 콜백은 세션을 붙잡지 않음 (weak_ptr) → 먼저 끊긴 세션은 그대로 해제되고 만료 시 무시
+    std::weak_ptr<Session> weak = shared_from_this();
+    auto id = wheel_->schedule(current_config()->login_timeout, [weak]() { // 예: 90초
+        auto self = weak.lock();
+        if (!self) return;
+        boost::asio::dispatch(self->strand_, [self]() {
+            if (self->nickname_registered_ || self->is_closed()) return;
+            std::cerr << "[LOGIN TIMEOUT] session_id=" << self->session_id_ << " Login timed out, session ended!" << std::endl;
+            static const PreframedReply kLoginTimeout(
+                R"({"type":"notice","msg":"Your connection has been terminated due to a login timeout."})" "\n");
+            self->post_write(kLoginTimeout);
             //close_session();
-            close_session();
-        }
+            self->close_session();
+            });
         });
+    wheel_->cancel(login_timer_id_.exchange(id));
 }
 
 void Session::on_nickname_registered() {
     nickname_registered_ = true;
-    set_state(SessionState::Ready); // 로그인 성공 상태로!
-    login_timer_.cancel(); // 인수 제거하여 타이머 취소  
+    // 로그인 성공 상태로! (그 사이 닫힌 세션은 Closed 유지)
+    SessionState state = get_state();
+    while (state != SessionState::Closed && !state_.compare_exchange_weak(state, SessionState::Ready)) {
+    }
+    wheel_->cancel(login_timer_id_.exchange({})); // O(1) 취소
+}
+
+// idle 만료: 읽을 때마다 타이머를 옮기지 않고 last_alive_time_ 만 갱신,
+// 만료 시점에 마지막 수신 시각을 보고 남은 시간만큼 다시 등록 (lazy 재무장)
+void Session::schedule_idle_check(std::chrono::steady_clock::duration delay) {
+    std::weak_ptr<Session> weak = shared_from_this();
+    auto id = wheel_->schedule(delay, [weak]() {
+        auto self = weak.lock();
+        if (!self) return;
+        boost::asio::dispatch(self->strand_, [self]() {
+            if (self->is_closed()) return;
+            auto idle_timeout = current_config()->idle_timeout;
+            if (idle_timeout.count() <= 0) return;   // reload 로 꺼짐
+            auto idle = std::chrono::steady_clock::now() - self->get_last_alive_time();
+            if (idle < idle_timeout) {
+                self->schedule_idle_check(idle_timeout - idle);
+                return;
+            }
+            LOG_SAMPLED(LogCategory::Session, spdlog::level::info, "[IDLE TIMEOUT] session_id={} - close session", self->session_id_);
+            self->close_session();
+            });
+        });
+    wheel_->cancel(idle_timer_id_.exchange(id));
 }
 
 //void Session::reset(boost::asio::ip::tcp::socket&& new_socket, int session_id) {
@@ -246,24 +313,32 @@ unsigned short Session::get_client_port() const {
     }
 }
 
-void Session::enqueue_write(std::shared_ptr<std::string> msg) {
+void Session::enqueue_write(OutboundRef msg, const RequestTrace& trace, WireFormat format) {
+    auto config = current_config();   // 메시지당 epoch 진입 + atomic load 1번
+    metrics::observe(metrics::Histogram::WriteQueueDepth, write_queue_.size());
     // 1. 80% 초과 경고만
-    if (write_queue_.size() >= static_cast<size_t>(AppContext::instance().config.value("write_queue_warn_threshold", 80))) {
-        AppContext::instance().logger->warn("[Session][enqueue_write] write_queue 임계치(80%) 초과: size={}", write_queue_.size());
+    if (write_queue_.size() >= config->write_queue_warn_threshold) {
+        LOG_SAMPLED(LogCategory::Session, spdlog::level::warn, "[Session][enqueue_write] write_queue 임계치(80%) 초과: size={}", write_queue_.size());
     }
 
     // 2. FULL(100%)이면 가장 오래된 것 drop, 연속이면 close
-    if (write_queue_.size() >= static_cast<size_t>(AppContext::instance().config.value("max_write_queue_size", 100))) {
-        AppContext::instance().logger->warn("[Session][enqueue_write] write_queue FULL! 가장 오래된 메시지 drop, 새 메시지 push");
-        write_queue_.pop();
+    if (write_queue_.size() >= config->max_write_queue_size) {
+        LOG_SAMPLED(LogCategory::Session, spdlog::level::warn, "[Session][enqueue_write] write_queue FULL! 가장 오래된 메시지 drop, 새 메시지 push");
+        // 전송 중인 메시지(버퍼가 async_write 에 물려 있음)는 건드리지 않고 그 다음 것을 drop
+        if (write_queue_.size() > write_in_flight_) {
+            write_queue_.erase(write_queue_.begin() + write_in_flight_);
+            release_pending_writes(1);
+            metrics::add(metrics::Counter::WriteQueueDrops);
+        }
 
         // 연속 FULL 카운트 증가
         ++write_queue_overflow_count_;
-        if (write_queue_overflow_count_ >= static_cast<size_t>(AppContext::instance().config.value("write_queue_overflow_limit", 10))) {
+        metrics::observe(metrics::Histogram::WriteQueueOverflowStreak, write_queue_overflow_count_);
+        if (write_queue_overflow_count_ >= config->write_queue_overflow_limit) {
+            metrics::add(metrics::Counter::WriteQueueOverflowCloses);
             AppContext::instance().logger->error("[Session][enqueue_write] write_queue FULL 연속 {}회, 세션 종료!", write_queue_overflow_count_);
-            closed_ = true;
-            // 실제 종료 처리가 필요하다면 여기에 추가!
-            // 예: socket_.lowest_layer().close();
+            close_session();             // 소켓 정리 + 레지스트리 제거 + SessionsClosed (대기 중인 생산자는 닫힘을 보고 빠짐)
+            release_pending_writes(1);   // 버린 새 메시지
             return;
         }
     }
@@ -272,24 +347,25 @@ void Session::enqueue_write(std::shared_ptr<std::string> msg) {
     }
 
     // 3. push
-    write_queue_.push(msg);
+    write_queue_.push_back(QueuedWrite{ std::move(msg), trace, format });
 }
 
 void Session::close_session() {
     if (closed_.exchange(true)) return;
     set_state(SessionState::Closed);
+    metrics::add(metrics::Counter::SessionsClosed);
 
     auto self = shared_from_this();
 
+    // 남은 세션 타이머 해제 (휠 slot 에서 바로 빠짐)
+    wheel_->cancel(login_timer_id_.exchange({}));
+    wheel_->cancel(idle_timer_id_.exchange({}));
+    // 송신 대기 중인 스트림 생산자가 종료를 보고 빠지게 (close_session 은 strand 밖에서도 불림)
+    boost::asio::dispatch(strand_, [self]() { self->wake_room_waiters(); });
+
     try {
         // TCP 소켓 안전하게 닫기 (비동기 종료 없음)
-        boost::system::error_code ec;
-
-        socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
-        if (ec) AppContext::instance().logger->error("[close_session] tcp shutdown error: {}", ec.message());
-
-        socket_.close(ec);
-        if (ec) AppContext::instance().logger->error("[close_session] tcp close error: {}", ec.message());
+        close_socket(0);
 
         // 마지막에 세션 제거 (핸들러에서 release 등 포함)
         if (auto handler = data_handler_.lock()) {
@@ -301,115 +377,294 @@ void Session::close_session() {
     }
 }
 
+void Session::close_socket(size_t attempt) {
+    boost::system::error_code ec;
+
+    socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    if (ec) AppContext::instance().logger->error("[close_session] tcp shutdown error: {}", ec.message());
+
+    socket_.close(ec);
+    if (!ec) return;
+    AppContext::instance().logger->error("[close_session] tcp close error: {} (attempt={})", ec.message(), attempt);
+
+    auto config = current_config();
+    if (attempt >= config->close_max_retries) {
+        AppContext::instance().logger->error("[close_session] close 재시도 포기 session_id={}", session_id_);
+        return;
+    }
+    // 재시도는 세션을 붙잡아 둠 (소켓이 닫힐 때까지 fd 유지)
+    auto self = shared_from_this();
+    wheel_->schedule(config->close_retry_delay, [self, attempt]() {
+        boost::asio::dispatch(self->strand_, [self, attempt]() { self->close_socket(attempt + 1); });
+        });
+}
+
+void Session::when_write_room(size_t high_water, std::chrono::milliseconds timeout, std::function<void(bool)> on_room) {
+    auto self = shared_from_this();
+    boost::asio::dispatch(strand_, [this, self, high_water, timeout, on_room = std::move(on_room)]() mutable {
+        if (closed_.load() || pending_writes_.load() < high_water) {
+            on_room(!closed_.load());
+            return;
+        }
+        WriteRoomWaiter waiter;
+        waiter.id = ++next_room_waiter_id_;
+        waiter.high_water = high_water;
+        waiter.on_room = std::move(on_room);
+        // stall timeout: 그동안 송신이 안 빠지면 생산자에게 false
+        std::weak_ptr<Session> weak = self;
+        waiter.timer = wheel_->schedule(timeout, [weak, id = waiter.id]() {
+            auto s = weak.lock();
+            if (!s) return;
+            boost::asio::dispatch(s->strand_, [s, id]() {
+                auto it = std::find_if(s->room_waiters_.begin(), s->room_waiters_.end(),
+                    [id](const WriteRoomWaiter& w) { return w.id == id; });
+                if (it == s->room_waiters_.end()) return;
+                auto on_room = std::move(it->on_room);
+                s->room_waiters_.erase(it);
+                on_room(false);
+            });
+        });
+        room_waiters_.push_back(std::move(waiter));
+    });
+}
+
+// write 완료/drop 경로 (strand 위)
+void Session::release_pending_writes(size_t count) {
+    if (count) pending_writes_.fetch_sub(count);
+    if (!room_waiters_.empty()) wake_room_waiters();
+}
+
+void Session::wake_room_waiters() {
+    bool closed = closed_.load();
+    size_t pending = pending_writes_.load();
+    std::vector<std::function<void(bool)>> ready;
+    for (auto it = room_waiters_.begin(); it != room_waiters_.end();) {
+        if (closed || pending < it->high_water) {
+            wheel_->cancel(it->timer);
+            ready.push_back(std::move(it->on_room));
+            it = room_waiters_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    // 콜백이 다시 when_write_room 을 불러도 되게 목록 정리 후 호출
+    for (auto& on_room : ready) {
+        on_room(!closed);
+    }
+}
+
+RecvStats& Session::recv_stats() {
+    static RecvStats stats;
+    return stats;
+}
+
+// reload 후 기존 세션은 do_read 에서 version 이 바뀐 것을 보고 다시 호출 (strand 위)
+void Session::apply_limits(const Config& config) {
+    write_batch_max_msgs_ = config.write_batch_max_msgs;
+    write_batch_max_bytes_ = config.write_batch_max_bytes;
+    recv_chunk_min_ = config.recv_buffer_min;
+    recv_chunk_max_ = config.recv_buffer_max;
+    recv_chunk_ = std::clamp(recv_chunk_, recv_chunk_min_, recv_chunk_max_);
+    msg_buf_mgr_.set_max_packet_size(config.max_packet_size);
+    limits_version_ = config.version;
+}
+
+// 전역 atomic 은 read 마다가 아니라 kRecvStatsFlushReads 번마다 / 세션 소멸 때 한 번에
+void Session::flush_recv_stats() {
+    if (recv_batch_.reads == 0) return;
+    auto& stats = recv_stats();
+    stats.reads.fetch_add(recv_batch_.reads, std::memory_order_relaxed);
+    stats.bytes.fetch_add(recv_batch_.bytes, std::memory_order_relaxed);
+    stats.frames.fetch_add(recv_batch_.frames, std::memory_order_relaxed);
+    stats.grows.fetch_add(recv_batch_.grows, std::memory_order_relaxed);
+    stats.shrinks.fetch_add(recv_batch_.shrinks, std::memory_order_relaxed);
+    recv_batch_ = RecvStatsBatch{};
+}
+
+// offered = 이번 read 에 실제로 넘긴 크기 (recv_chunk_ 로 잘라서 넘김)
+// after_idle = 직전 read 로부터 kRecvIdleShrinkAfter 이상 지난 read
+void Session::adapt_recv_buffer(size_t length, size_t offered, size_t frames, bool after_idle) {
+    ++recv_batch_.reads;
+    recv_batch_.bytes += length;
+    recv_batch_.frames += frames;
+    if (recv_batch_.reads >= kRecvStatsFlushReads) flush_recv_stats();
+
+    // 준 공간을 꽉 채웠으면 아직 소켓에 더 있을 가능성 → 다음 read 는 2배
+    if (length >= offered && recv_chunk_ < recv_chunk_max_) {
+        recv_chunk_ = std::min(recv_chunk_ * 2, recv_chunk_max_);
+        small_read_streak_ = 0;
+        ++recv_batch_.grows;
+        return;
+    }
+
+    // 한동안 조용하던 세션: 버스트 때 키운 크기를 바로 최소로 되돌림 (버퍼가 비어 있으면 메모리도 반환)
+    if (after_idle && recv_chunk_ > recv_chunk_min_) {
+        recv_chunk_ = recv_chunk_min_;
+        small_read_streak_ = 0;
+        msg_buf_mgr_.shrink_to(recv_chunk_);
+        ++recv_batch_.shrinks;
+        return;
+    }
+
+    // 1/4 도 못 채우는 read 가 계속되면 절반으로 줄이고, 버퍼가 비어 있으면 메모리도 반환
+    if (length * 4 <= recv_chunk_) {
+        if (++small_read_streak_ >= kRecvShrinkAfterSmallReads && recv_chunk_ > recv_chunk_min_) {
+            recv_chunk_ = std::max(recv_chunk_ / 2, recv_chunk_min_);
+            small_read_streak_ = 0;
+            msg_buf_mgr_.shrink_to(recv_chunk_);
+            ++recv_batch_.shrinks;
+        }
+    }
+    else {
+        small_read_streak_ = 0;
+    }
+}
+
 void Session::do_read() 
 {
-    AppContext::instance().logger->info("[TRACK] do_read() 진입, session_id={}", get_session_id());
+    LOG_TRACK("[TRACK] do_read() 진입, session_id={}", get_session_id());
     auto self = shared_from_this();
+    // start() 처럼 strand 밖에서 불린 경우만 strand 로 넘김 (read 콜백에서는 이미 strand 위라 바로 진행)
+    if (!strand_.running_in_this_thread()) {
+        boost::asio::dispatch(strand_, [self]() { self->do_read(); });
+        return;
+    }
     // [1] 중복 read 방지!
     if (get_state() == SessionState::Closed) {
-        AppContext::instance().logger->warn("Closed session: 콜백/메시지 무시 [session_id={}]", get_session_id());
+        LOG_SAMPLED(LogCategory::Session, spdlog::level::warn, "Closed session: 콜백/메시지 무시 [session_id={}]", get_session_id());
         return;
     }
     if (!try_acquire_read()) {
         //cerr << "[WARN] 중복 do_read 감지! session_id=" << session->get_session_id() << endl;
-        AppContext::instance().logger->info("[WARN] 중복 do_read 감지! session_id= {}", get_session_id());
+        LOG_SAMPLED(LogCategory::Net, spdlog::level::info, "[WARN] 중복 do_read 감지! session_id= {}", get_session_id());
         return;
     }
-    // do_read를 직접 호출하지 않고, post_task로 감싼다.
-    post_task([this, self]() {
-        auto& strand = get_strand();
-        get_socket().async_read_some(
-            buffer(get_data(), sizeof(get_data())),
-            boost::asio::bind_executor(strand, [this, self](const boost::system::error_code& ec, size_t length) {
-                // [2] 콜백 진입 시 반드시 해제!
-                release_read();
-
-                try {
-                    if (!ec) {
-                        // 1. 누적 버퍼에 append
-                        get_msg_buffer().append(get_data(), length);
-
-                        // 2. 여러 메시지 추출 및 처리
-                        while (auto opt_msg = get_msg_buffer().extract_message()) {
-                            try {
-                                //json msg = json::parse(*opt_msg);
-
-                                AppContext::instance().logger->info("[DEBUG] Received JSON raw: {}", *opt_msg);
-                                // 파싱 성공한 JSON 객체 로그 (보기 좋게 indent 적용)
-                                //AppContext::instance().logger->info("[DEBUG] Parsed JSON object: {}", msg.dump(2));
-
-                                //if (auto handler = data_handler_.lock()) {
-                                //    handler->dispatch(self, msg);  // 바로 이렇게!
-                                //}
-                                if (auto handler = data_handler_.lock()) {
-                                    handler->dispatch(self, *opt_msg); // std::string (raw packet)
-                                }
-                            }
-                            catch (const exception& e) {
-                                cerr << "[JSON parsing error] " << e.what() << " / data: " << *opt_msg << endl;
-                                set_message(R"({"type":"error","msg":"Message parsing failed"})" "\n");
-                                //do_write(self);
-                                post_write(get_message());
-                                // 에러 시에도 계속 다음 메시지 분리/처리
+    // reload 된 세션별 한도는 여기서 반영 (read 당 epoch 진입 + atomic load 1번 + 비교)
+    auto config = current_config();
+    if (config->version != limits_version_) {
+        apply_limits(*config);
+    }
+    // strand 위에서 바로 read 를 건다 (별도 task 큐 없이 strand 가 직렬화 담당)
+    // 누적 버퍼의 빈 꼬리 공간에 바로 읽음 (중간 복사 없음)
+    // prepare 는 recv_chunk_ 이상인 빈 꼬리 전체를 돌려주므로 read 크기는 recv_chunk_ 로 자름 (크기 조정 기준과 일치)
+    auto recv_space = boost::asio::buffer(get_msg_buffer().prepare(recv_chunk_), recv_chunk_);
+    size_t offered = recv_space.size();
+    get_socket().async_read_some(
+        recv_space,
+        boost::asio::bind_executor(strand_, [this, self, offered](const boost::system::error_code& ec, size_t length) {
+            // [2] 콜백 진입 시 반드시 해제!
+            release_read();
+
+            try {
+                if (!ec) {
+                    // 1. 읽은 만큼 누적 버퍼에 확정
+                    get_msg_buffer().commit(length);
+                    auto prev_alive = get_last_alive_time();
+                    update_alive_time();   // idle 만료 기준 (타이머는 만료 시점에 lazy 재무장)
+                    bool after_idle = get_last_alive_time() - prev_alive >= kRecvIdleShrinkAfter;
+
+                    // 2. 여러 메시지 추출 및 처리
+                    //    요청마다 trace 를 만들어 dispatch 동안 current_trace_ 로 노출 (응답 write 완료에서 마감)
+                    bool trace_enabled = current_config()->trace_enabled;
+                    auto read_at = trace_enabled ? RequestTrace::clock::now() : RequestTrace::clock::time_point{};
+                    size_t frames = 0;
+                    // 처리 도중 세션이 닫히면(secret 실패, 모니터의 미인증 정리 등) 남은 프레임은 dispatch 하지 않음
+                    while (!is_closed()) {
+                        auto opt_msg = get_msg_buffer().extract_message();
+                        if (!opt_msg) break;
+                        ++frames;
+                        RequestTrace trace;
+                        if (trace_enabled) {
+                            trace.session_id = session_id_;
+                            trace.set(TraceStage::Read, read_at);
+                            trace.mark(TraceStage::Frame);
+                            current_trace_ = &trace;
+                        }
+                        try {
+                            //json msg = json::parse(*opt_msg);
+
+                            LOG_DEBUG("[DEBUG] Received JSON raw: {}", *opt_msg);
+                            // 파싱 성공한 JSON 객체 로그 (보기 좋게 indent 적용)
+                            //AppContext::instance().logger->info("[DEBUG] Parsed JSON object: {}", msg.dump(2));
+
+                            //if (auto handler = data_handler_.lock()) {
+                            //    handler->dispatch(self, msg);  // 바로 이렇게!
+                            //}
+                            if (auto handler = data_handler_.lock()) {
+                                handler->dispatch(self, *opt_msg); // string_view (수신 버퍼 안의 raw packet)
                             }
                         }
-                        // 비정상 길이 감지 로그 및 세션 종료 
-                        if (get_msg_buffer().was_last_clear_by_invalid_length()) {
-                            AppContext::instance().logger->warn("[TCP] 비정상/과도한 패킷 길이 감지! 세션 강제 종료 session_id={}", get_session_id());
-                            close_session();
-                            return;  // read loop 탈출
+                        catch (const exception& e) {
+                            cerr << "[JSON parsing error] " << e.what() << " / data: " << *opt_msg << endl;
+                            static const PreframedReply kParseFailed(
+                                R"({"type":"error","msg":"Message parsing failed"})" "\n");
+                            //do_write(self);
+                            post_write(kParseFailed);
+                            // 에러 시에도 계속 다음 메시지 분리/처리
+                        }
+                        // 응답 없이 끝난 요청 (또는 세션 종료) → 여기까지로 마감
+                        if (current_trace_) {
+                            current_trace_ = nullptr;
+                            tracing::finish(trace);
                         }
+                    }
+                    // 비정상 길이 감지 로그 및 세션 종료 
+                    if (get_msg_buffer().was_last_clear_by_invalid_length()) {
+                        AppContext::instance().logger->warn("[TCP] 비정상/과도한 패킷 길이 감지! 세션 강제 종료 session_id={}", get_session_id());
+                        close_session();
+                        return;  // read loop 탈출
+                    }
+                    if (is_closed()) return;   // dispatch 중에 닫힘 → 다시 read 하지 않음
 
-                        // 3. 계속해서 read (이 구조면 wrote 체크 필요 없음)
-                        do_read();
+                    // 3. 수신 버퍼 크기 조정 후 계속해서 read (이 구조면 wrote 체크 필요 없음)
+                    adapt_recv_buffer(length, offered, frames, after_idle);
+                    do_read();
+                }
+                else if (ec == boost::asio::error::eof) {
+                    cout << "Client disconnected." << endl;
+                    // 퇴장 알림
+                    string nickname = self->get_nickname();
+                    json notice;
+                    notice["type"] = "notice";
+                    notice["msg"] = nickname + " has left.";
+
+                    self->close_session();  // 세션 종료
+                }
+                else if (ec == boost::asio::error::connection_reset) {
+                    cout << "Client forcibly disconnected." << endl;
+                    string nickname = self->get_nickname();
+                    if (nickname.empty()) {
+                        AppContext::instance().logger->warn("[Connection reset] Client disconnected without a nickname. {}", self->get_session_id());
+                        cerr << "Client disconnected without a nickname." << endl;
                     }
-                    else if (ec == boost::asio::error::eof) {
-                        cout << "Client disconnected." << endl;
-                        // 퇴장 알림
-                        string nickname = self->get_nickname();
+                    else {
                         json notice;
                         notice["type"] = "notice";
                         notice["msg"] = nickname + " has left.";
 
-                        self->close_session();  // 세션 종료
+                        std::cout << "Client with nickname '" << nickname << "' disconnected." << std::endl;
                     }
-                    else if (ec == boost::asio::error::connection_reset) {
-                        cout << "Client forcibly disconnected." << endl;
-                        string nickname = self->get_nickname();
-                        if (nickname.empty()) {
-                            AppContext::instance().logger->warn("[Connection reset] Client disconnected without a nickname. {}", self->get_session_id());
-                            cerr << "Client disconnected without a nickname." << endl;
-                        }
-                        else {
-                            json notice;
-                            notice["type"] = "notice";
-                            notice["msg"] = nickname + " has left.";
-
-                            std::cout << "Client with nickname '" << nickname << "' disconnected." << std::endl;
-                        }
 
-                        //self->close_session();
-                        close_session();
-                    }
-                    else if (ec == boost::asio::error::operation_aborted) {
-                        // [995] 소켓 종료, 타이머 취소 등에서 발생하는 "정상 종료 케이스"
-                        // cout << "[INFO] Read cancelled by server shutdown or session close." << endl;
-                        // 로그를 아예 안 찍거나, INFO/DEBUG로만 출력
-                    }
-                    else {
-                        cerr << "Read failed: [" << ec.value() << "] " << ec.message() << endl;
-                        //self->close_session();
-                        close_session();
-                    }
+                    //self->close_session();
+                    close_session();
                 }
-                catch (const exception& e) {
-                    cerr << "[FATAL][do_read handler 예외] " << e.what() << endl;
+                else if (ec == boost::asio::error::operation_aborted) {
+                    // [995] 소켓 종료, 타이머 취소 등에서 발생하는 "정상 종료 케이스"
+                    // cout << "[INFO] Read cancelled by server shutdown or session close." << endl;
+                    // 로그를 아예 안 찍거나, INFO/DEBUG로만 출력
+                }
+                else {
+                    cerr << "Read failed: [" << ec.value() << "] " << ec.message() << endl;
                     //self->close_session();
                     close_session();
                 }
-                self->run_next_task(); // 항상 마지막에!
-
-                })
-        );
-        });
+            }
+            catch (const exception& e) {
+                cerr << "[FATAL][do_read handler 예외] " << e.what() << endl;
+                //self->close_session();
+                close_session();
+            }
+            })
+    );
 }
\ No newline at end of file
@@ -1,20 +1,66 @@
 ﻿#pragma once
 #include "DataHandler.h"
 #include "MessageBufferManager.h"
+#include "WireFormat.h"
+#include "TimerWheel.h"
+#include "RequestTrace.h"
 #include <boost/asio.hpp>
 #include <boost/asio/strand.hpp>
-#include <boost/asio/steady_timer.hpp>
 #include <memory>
 #include <string>
-#include <queue>
+#include <deque>
+#include <array>
+#include <vector>
 #include <optional>
+#include <functional>
 
 class DataHandler;  // 전방 선언: DataHandler 클래스
+struct Config;
 
 enum class SessionState { Handshaking, Handshaked, LoginWait, Ready, Closed };
+const int kRecvShrinkAfterSmallReads = 16;  // 작은 read 가 연속 이만큼이면 수신 버퍼 축소
+constexpr std::chrono::seconds kRecvIdleShrinkAfter{ 5 };   // 직전 read 와 이만큼 떨어진 read 면 수신 버퍼를 최소로
+constexpr uint64_t kRecvStatsFlushReads = 64;               // 세션별로 모았다가 이 read 수마다 전역 통계에 합산
+
+// 수신 경로 통계 (전체 세션 합산, 모니터 루프에서 출력)
+struct RecvStats {
+    std::atomic<uint64_t> reads{ 0 };      // async_read_some 완료 횟수 (= recv syscall)
+    std::atomic<uint64_t> bytes{ 0 };
+    std::atomic<uint64_t> frames{ 0 };     // 추출된 메시지 수
+    std::atomic<uint64_t> grows{ 0 };
+    std::atomic<uint64_t> shrinks{ 0 };
+};
+
+// 세션 하나가 모아 두는 수신 통계 (strand 에서만, RecvStats 에 묶어서 합산)
+struct RecvStatsBatch {
+    uint64_t reads = 0;
+    uint64_t bytes = 0;
+    uint64_t frames = 0;
+    uint64_t grows = 0;
+    uint64_t shrinks = 0;
+};
+
+// 송신 경로 통계 (전체 세션 합산)
+struct SendStats {
+    std::atomic<uint64_t> writes{ 0 };     // async_write 횟수
+    std::atomic<uint64_t> messages{ 0 };   // 보낸 메시지 수
+    std::atomic<uint64_t> bytes{ 0 };
+};
+
+// 송신 대기 메시지 + 이 응답으로 끝나는 요청의 trace (요청과 무관한 메시지는 빈 trace)
+struct QueuedWrite {
+    OutboundRef msg;
+    RequestTrace trace;
+    WireFormat format = WireFormat::Json;   // 인코딩된 포맷 (post 시점, hello_ack 처럼 전환 직전 메시지도 제 포맷으로 집계)
+};
 
-const int kMaxCloseRetries = 3;   // 재시도 횟수
-const int kRetryDelayMs = 100;  // 재시도 간격(ms)
+// 송신 대기가 줄기를 기다리는 strand 밖 생산자 (select_stream 등)
+struct WriteRoomWaiter {
+    uint64_t id = 0;
+    size_t high_water = 0;
+    std::function<void(bool)> on_room;   // true = 자리 남, false = 세션 종료 또는 timeout
+    TimerWheel::TimerId timer{};
+};
 
 // SSL 세션을 관리하는 클래스
 class Session : public std::enable_shared_from_this<Session> {
@@ -23,27 +69,45 @@ private:
 
     boost::asio::ip::tcp::socket socket_;                            // 소켓
     boost::asio::strand<boost::asio::any_io_executor> strand_;       // 수정된 strand_ 타입
-    char data_[2048];                                                // 데이터를 읽을 버퍼
     std::string message_;                                            // 서버에서 보낼 메시지를 저장하는 변수 
     int session_id_;                                                 // 세션을 식별하기 위한 세션 ID
     std::string nickname_;
     std::string line_buffer_;                                        // 세션 멤버에 추가
     std::weak_ptr<DataHandler> data_handler_;                        // DataHandler 포인터
     std::atomic<bool> read_pending_{ false };
-    std::queue<std::function<void()>> task_queue_;                   // 직렬화 큐 관련 추가
-    bool task_running_ = false;
 
     MessageBufferManager msg_buf_mgr_;                               // 누적 버퍼
-    std::queue<std::shared_ptr<std::string>> write_queue_;
+    size_t recv_chunk_ = 4096;                                       // read 한 번에 확보할 수신 공간 (트래픽 따라 가변)
+    size_t recv_chunk_min_ = 1024;
+    size_t recv_chunk_max_ = 65536;
+    int small_read_streak_ = 0;                                      // 연속으로 작은 read 횟수
+    RecvStatsBatch recv_batch_;                                      // 전역 RecvStats 에 아직 안 더한 값
+    std::deque<QueuedWrite> write_queue_;                            // 프리픽스까지 채워진 송신 버퍼
     bool write_in_progress_ = false;                                 // 현재 write 중인지
+    size_t write_in_flight_ = 0;                                     // write_queue_ 앞쪽에서 전송 중인 메시지 수
+    std::atomic<WireFormat> wire_format_{ WireFormat::Json };        // 송수신 인코딩 (hello 로 협상)
+    bool wire_format_locked_ = false;                                // 첫 프레임 처리 후 true (strand 에서만 접근)
+    size_t write_batch_max_msgs_ = 64;                               // async_write 한 번에 묶을 최대 메시지 수
+    size_t write_batch_max_bytes_ = 65536;                           // async_write 한 번에 묶을 최대 바이트
+    uint64_t limits_version_ = 0;                                    // 위 한도를 가져온 Config version (strand 에서만)
+    std::vector<boost::asio::const_buffer> write_bufs_;              // scatter/gather 버퍼 목록 (재사용)
+    RequestTrace* current_trace_ = nullptr;                          // dispatch 중인 요청의 trace (strand 에서만, 첫 응답이 가져감)
+
+    // 송신 흐름 제어 (strand 밖 생산자용): post 된 뒤 아직 write 가 끝나지 않은 메시지 수
+    std::atomic<size_t> pending_writes_{ 0 };
+    std::vector<WriteRoomWaiter> room_waiters_;                      // write 완료 때 깨울 생산자 (strand 에서만 접근)
+    uint64_t next_room_waiter_id_ = 0;
     std::atomic<bool> closed_{ false };                              // 중복 종료 방지 플래그 추가
 
-    boost::asio::steady_timer login_timer_;                          // 닉네임 입력 타이머
+    // 세션 타이머는 io_context 의 타이머 휠에 등록 (세션마다 steady_timer 를 두지 않음)
+    TimerWheel* wheel_ = nullptr;
+    std::atomic<TimerWheel::TimerId> login_timer_id_{};              // 닉네임 입력 타이머
+    std::atomic<TimerWheel::TimerId> idle_timer_id_{};               // idle 만료 타이머
     std::atomic<bool> nickname_registered_{ false };                 // 닉네임 입력 상태 플래그
 
     // 글로벌 keepalive 관련 => 클라 heartbeat 구조로 변경
     std::atomic<std::chrono::steady_clock::time_point> last_alive_time_{};
-    SessionState state_ = SessionState::Handshaking;                 // 초기값 Handshaking
+    std::atomic<SessionState> state_{ SessionState::Handshaking };   // 초기값 Handshaking (close_session / 모니터 스레드와 공유)
 
     int zone_id_ = 0; // 기본 0 = 미배정
 
@@ -64,10 +128,6 @@ public:
     // 세션 ID 가져오기
     int get_session_id() const;
 
-    // 메시지 큐 직렬화 관련
-    void post_task(std::function<void()> fn);
-    void run_next_task();
-
     // Getter for message_  
     const std::string& get_message() const { return message_; }
 
@@ -80,9 +140,6 @@ public:
 
     boost::asio::strand<boost::asio::any_io_executor>& get_strand() { return strand_; }  // 수정된 반환 타입
 
-    char* get_data() { return data_; }              // 읽기 전용 버퍼를 반환하는 함수
-    const char* get_data() const { return data_; }  // 읽기 전용 버퍼를 반환하는 함수 (const 버전)
-
     // nickname 설정 및 가져오기
     void set_nickname(const std::string& n) { nickname_ = n; }
     void set_nickname(std::string&& n) { nickname_ = std::move(n); }
@@ -106,14 +163,30 @@ public:
 
     // Getter for recv_buffer_  
     MessageBufferManager& get_msg_buffer() { return msg_buf_mgr_; }
+    size_t get_recv_chunk() const { return recv_chunk_; }
+
+    // 수신/송신 통계 (전체 세션 합산)
+    static RecvStats& recv_stats();
+    static SendStats& send_stats();
     // write 메시지 큐 관련 함수 (직렬화)
-    void post_write(const std::string& msg);
-    void post_write(std::shared_ptr<std::string> msg); // 새 버전
+    void post_write(const std::string& json_text);   // JSON 텍스트 → 세션 포맷으로 인코딩 (Json 세션은 그대로)
+    void post_write(OutboundRef msg);   // 새 버전 (static preframed 상수 응답은 할당 없이 그대로 전달)
+    void post_write(OutboundRef msg, const RequestTrace& trace);   // 비동기 완료(DB 등) 응답: 요청 trace 를 이어서 write 완료까지
+    void post_write(const PreframedReply& reply) { post_write(reply.get(get_wire_format())); }  // 세션 포맷에 맞는 상수 응답
+    void post_write(const PreframedReply& reply, const RequestTrace& trace) { post_write(reply.get(get_wire_format()), trace); }
+    void post_message(const nlohmann::json& msg) { post_write(encode_message(get_wire_format(), msg)); }
+
+    // 메시지 인코딩 협상 (hello 는 첫 프레임에서만 허용)
+    WireFormat get_wire_format() const { return wire_format_.load(std::memory_order_relaxed); }
+    void set_wire_format(WireFormat format) { wire_format_.store(format, std::memory_order_relaxed); }
+    bool is_wire_format_locked() const { return wire_format_locked_; }
+    void lock_wire_format() { wire_format_locked_ = true; }
 
     // Session 재설정 함수
     //void reset(boost::asio::ip::tcp::socket&& socket, int session_id);
 
     void start_login_timeout();            // 닉네임 타이머 시작
+    void schedule_idle_check(std::chrono::steady_clock::duration delay);   // idle 만료 타이머 (재무장 포함)
     void on_nickname_registered();         // 닉네임 등록 완료 콜백
     bool is_nickname_registered() const { return nickname_registered_.load(); }
 
@@ -127,18 +200,38 @@ public:
 
     bool is_closed() const { return closed_.load(); }
 
+    // 스트리밍 생산자(DB 워커 등 strand 밖)용: 송신 대기가 high_water 미만이 되면 write 완료 경로(strand)에서 on_room(true)
+    // 세션 종료 또는 timeout 이면 on_room(false). 블로킹하지 않음 (생산자는 콜백에서 다시 이어서 생산)
+    void when_write_room(size_t high_water, std::chrono::milliseconds timeout, std::function<void(bool)> on_room);
+    size_t pending_writes() const { return pending_writes_.load(); }
+
+    // 요청 trace: dispatch 중(strand 위)에만 유효. 동기 응답은 post_write 가 자동으로 붙이고,
+    // 비동기로 응답할 핸들러는 take_trace() 로 떼어 가서 post_write(msg, trace) 로 넘김
+    RequestTrace* current_trace() { return current_trace_; }
+    RequestTrace take_trace() {
+        RequestTrace trace;
+        if (current_trace_) {
+            trace = *current_trace_;
+            current_trace_ = nullptr;
+        }
+        return trace;
+    }
+
     // 상태 가져오기
-    SessionState get_state() const { return state_; }
+    SessionState get_state() const { return state_.load(); }
     // 상태 설정 (필요하면 public, 아니라면 protected/private로)
-    void set_state(SessionState s) { state_ = s; }
+    void set_state(SessionState s) { state_.store(s); }
+    // from 일 때만 to 로 (다른 스레드가 먼저 Closed 로 바꿨으면 false, 종료된 세션을 되살리지 않음)
+    bool transition_state(SessionState from, SessionState to) { return state_.compare_exchange_strong(from, to); }
 
     std::string get_client_ip() const;      // 클라이언트 IP 주소를 가져오는 함수
     unsigned short get_client_port() const; // 클라이언트 포트를 가져오는 함수
 
     // 세션 상태를 문자열로 변환 (디버깅용)
     std::string state_to_string() const {
-        switch (state_) {
+        switch (state_.load()) {
         case SessionState::Handshaking: return "Handshaking";
+        case SessionState::Handshaked: return "Handshaked";
         case SessionState::LoginWait: return "LoginWait";
         case SessionState::Ready: return "Ready";
         case SessionState::Closed: return "Closed";
@@ -146,7 +239,7 @@ public:
         }
     }
 
-    void enqueue_write(std::shared_ptr<std::string> msg);
+    void enqueue_write(OutboundRef msg, const RequestTrace& trace, WireFormat format);
 
     uint64_t get_generation() const { return generation_.load(); }
     void increment_generation() { ++generation_; }
@@ -154,7 +247,6 @@ public:
     void set_active(bool v) { active_ = v; }
     bool is_active() const { return active_.load(); }
 
-    boost::asio::steady_timer retry_timer_;  // 재시도 타이머
     void close_session();
     void do_read();
 
@@ -167,5 +259,11 @@ public:
 
 private:
     void do_write_queue();
+    void adapt_recv_buffer(size_t length, size_t offered, size_t frames, bool after_idle);   // read 결과로 수신 버퍼 크기 조정
+    void flush_recv_stats();                                                // recv_batch_ → 전역 RecvStats
+    void apply_limits(const Config& config);                                // 세션별 버퍼/패킷/배치 한도 (reload 되면 다음 read 때 다시)
+    void close_socket(size_t attempt);     // 실패 시 타이머 휠로 재시도
+    void release_pending_writes(size_t count);   // write 완료/drop 만큼 pending_writes_ 감소 + 대기 중인 생산자 깨움
+    void wake_room_waiters();                     // 자리가 났거나 종료된 세션의 대기 생산자 호출 (strand 위)
 
 };
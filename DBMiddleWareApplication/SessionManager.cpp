@@ -1,190 +1,192 @@
 ﻿#include "SessionManager.h"
 #include "Logger.h"
+#include <algorithm>
 #include <chrono>
 #include "AppContext.h"
+#include "Epoch.h"
+
+namespace {
+    // 정렬된 스냅샷에서 session_id 위치 (없으면 삽입 위치)
+    SessionManager::SessionSnapshot::const_iterator lower_bound_id(const SessionManager::SessionSnapshot& snapshot, int session_id) {
+        return std::lower_bound(snapshot.begin(), snapshot.end(), session_id,
+            [](const SessionManager::SessionEntry& entry, int id) { return entry.first < id; });
+    }
+}
 
 SessionManager::SessionManager(size_t shard_count)
-    : shard_count_(shard_count),
-    session_buckets_(shard_count),
-    session_mutexes_(shard_count)
+    : shard_count_(std::max(shard_count, kMinShards)),
+    shards_(shard_count_),
+    nickname_shards_(kNicknameShards)
 {
+    for (size_t shard = 0; shard < shard_count_; ++shard) {
+        publish_snapshot(shard, new SessionSnapshot());
+    }
+}
+
+// 소멸 시점에는 reader 가 없음 → 현재 스냅샷과 항목은 바로 해제 (이전 스냅샷은 이미 retire 됨)
+SessionManager::~SessionManager() {
+    for (size_t shard = 0; shard < shard_count_; ++shard) {
+        const SessionSnapshot* snapshot = load_snapshot(shard);
+        for (const auto& entry : *snapshot) {
+            delete entry.second;
+        }
+        delete snapshot;
+    }
 }
 
 void SessionManager::add_session(std::shared_ptr<Session> session) {
     int session_id = session->get_session_id();
     int shard = get_shard(session_id);
+    auto owned = std::make_unique<const std::shared_ptr<Session>>(std::move(session));
 
-    std::shared_ptr<Session> replaced_session;
+    const std::shared_ptr<Session>* replaced_entry = nullptr;
+    const SessionSnapshot* old_snapshot = nullptr;   // 이전 스냅샷 retire 는 락 밖에서
     {
-        std::lock_guard<std::mutex> lock(session_mutexes_[shard]);
-        auto& bucket = session_buckets_[shard];
-        auto it = bucket.find(session_id);
-        if (it != bucket.end()) {
-            replaced_session = it->second;  // 기존 세션 저장
-            bucket.erase(it);
+        std::lock_guard<std::mutex> lock(shards_[shard].write_mutex);
+        old_snapshot = load_snapshot(shard);
+        auto next = std::make_unique<SessionSnapshot>();
+        next->reserve(old_snapshot->size() + 1);
+
+        // id 는 대부분 증가 순으로 들어오므로 보통 맨 뒤에 붙음
+        auto pos = lower_bound_id(*old_snapshot, session_id);
+        next->assign(old_snapshot->begin(), pos);
+        if (pos != old_snapshot->end() && pos->first == session_id) {
+            replaced_entry = pos->second;  // 기존 세션 항목
+            ++pos;
         }
-        bucket[session_id] = session; // 새 세션 등록
+        else {
+            session_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        next->emplace_back(session_id, owned.release()); // 새 세션 등록
+        next->insert(next->end(), pos, old_snapshot->end());
+        publish_snapshot(shard, next.release());
     }
+    epoch::retire(old_snapshot);
 
     // 락을 벗어난 뒤에 안전하게 자원 정리
-    if (replaced_session && !replaced_session->is_closed()) {
-        replaced_session->close_session();
-        // 필요하면 세션 풀에도 반환 (DataHandler가 호출한 쪽에서 처리하는 게 깔끔)
+    if (replaced_entry) {
+        std::shared_ptr<Session> replaced_session = *replaced_entry;
+        epoch::retire(replaced_entry);
+        if (!replaced_session->is_closed()) {
+            replaced_session->close_session();
+            // 필요하면 세션 풀에도 반환 (DataHandler가 호출한 쪽에서 처리하는 게 깔끔)
+        }
     }
 }
 
 std::shared_ptr<Session> SessionManager::remove_session(int session_id) {
     int shard = get_shard(session_id);
-    std::shared_ptr<Session> removed_session;
+    const std::shared_ptr<Session>* removed_entry = nullptr;
+    const SessionSnapshot* old_snapshot = nullptr;
     {
-        std::lock_guard<std::mutex> lock(session_mutexes_[shard]);
-        auto it = session_buckets_[shard].find(session_id);
-        if (it != session_buckets_[shard].end()) {
-            removed_session = it->second;
-            session_buckets_[shard].erase(it);
+        std::lock_guard<std::mutex> lock(shards_[shard].write_mutex);
+        old_snapshot = load_snapshot(shard);
+        auto pos = lower_bound_id(*old_snapshot, session_id);
+        if (pos == old_snapshot->end() || pos->first != session_id) {
+            return nullptr;   // 이미 제거됨 (복사 없음)
         }
+        removed_entry = pos->second;
+
+        auto next = std::make_unique<SessionSnapshot>();
+        next->reserve(old_snapshot->size() - 1);
+        next->assign(old_snapshot->begin(), pos);
+        next->insert(next->end(), pos + 1, old_snapshot->end());
+        publish_snapshot(shard, next.release());
+        session_count_.fetch_sub(1, std::memory_order_relaxed);
     }
+    std::shared_ptr<Session> removed_session = *removed_entry;
+    epoch::retire(old_snapshot);
+    epoch::retire(removed_entry);   // 이전 스냅샷으로 순회 중인 쪽이 아직 항목을 볼 수 있음
     return removed_session;
 }
 
 std::shared_ptr<Session> SessionManager::find_session(int session_id) {
-    int shard = get_shard(session_id);
-    std::lock_guard<std::mutex> lock(session_mutexes_[shard]);
-    auto it = session_buckets_[shard].find(session_id);
-    if (it != session_buckets_[shard].end())
-        return it->second;
+    epoch::Guard guard;
+    const SessionSnapshot& snapshot = *load_snapshot(get_shard(session_id));
+    auto pos = lower_bound_id(snapshot, session_id);
+    if (pos != snapshot.end() && pos->first == session_id)
+        return *pos->second;
     return nullptr;
 }
 
 void SessionManager::for_each_session(const std::function<void(const std::shared_ptr<Session>&)>& fn) {
-    // 내부 샤드별 락 + 전체 세션 복사(락 보장)
-    std::vector<std::shared_ptr<Session>> sessions;
-    for (unsigned int shard = 0; shard < shard_count_; ++shard) {
-        std::lock_guard<std::mutex> lock(session_mutexes_[shard]);
-        for (const auto& [id, sess] : session_buckets_[shard]) {
-            if (sess) sessions.push_back(sess);
-        }
-    }
-    for (const auto& sess : sessions) {
-        fn(sess);
-    }
-}
-
-
-size_t SessionManager::session_count() {
-    size_t total = 0;
+    // 호출 시점의 shard 스냅샷 포인터만 모아 두고 순회 (세션 shared_ptr 복사 없음)
+    // fn 안에서 close_session → remove_session 이 새 스냅샷을 발행해도 guard 가 끝날 때까지 여기서 보는 스냅샷/항목은 유효
+    epoch::Guard guard;
+    std::vector<const SessionSnapshot*> snapshots;
+    snapshots.reserve(shard_count_);
     for (size_t shard = 0; shard < shard_count_; ++shard) {
-        std::lock_guard<std::mutex> lock(session_mutexes_[shard]);
-        total += session_buckets_[shard].size();
+        snapshots.push_back(load_snapshot(shard));
+    }
+    for (const SessionSnapshot* snapshot : snapshots) {
+        for (const auto& [id, entry] : *snapshot) {
+            if (*entry) fn(*entry);
+        }
     }
-    return total;
 }
 
 // 닉네임 관리
 void SessionManager::register_nickname(const std::string& nickname, std::shared_ptr<Session> session) {
-    AppContext::instance().logger->info("[DEBUG][TCP] SessionManager address: {}", (void*)this);
-    std::lock_guard<std::mutex> lock(nickname_mutex_);
-    auto it = nickname_index_.find(nickname);
-    if (it != nickname_index_.end()) {
-        auto prev = it->second.lock();
-        if (prev && prev != session) {
-            // [1] 이전 세션 강제 종료
-            prev->post_write(R"({"type":"error","msg":"다른 곳에서 로그인되어 기존 연결이 종료됩니다."})" "\n");
-            prev->close_session();
-            // **여기서 바로 nickname_index_를 overwrite하면, prev의 unregister_nickname이 꼬일 수 있으니**
-            // (optionally) prev가 unregister_nickname을 호출할 때만 nickname_index_에서 지우도록 함
-        }
+    LOG_DEBUG("[DEBUG][TCP] SessionManager address: {}", (void*)this);
+    std::shared_ptr<Session> prev;
+    {
+        auto& shard = nickname_shard(nickname);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto& entry = shard.index[nickname];
+        prev = entry.lock();
+        entry = session; // 무조건 overwrite (단, unregister시 “소유자”만 삭제)
     }
 
-    nickname_index_[nickname] = session; // 무조건 overwrite (단, unregister시 “소유자”만 삭제)
+    if (prev && prev != session) {
+        // [1] 이전 세션 강제 종료 (shard 락 밖에서: close_session 이 다른 락을 잡아도 안전)
+        static const PreframedReply kDuplicateLogin(
+            R"({"type":"error","msg":"다른 곳에서 로그인되어 기존 연결이 종료됩니다."})" "\n");
+        prev->post_write(kDuplicateLogin);
+        prev->close_session();
+        // prev 의 unregister_nickname 은 소유자가 아니므로 새 항목을 지우지 않음
+    }
 }
 
 void SessionManager::unregister_nickname(const std::string& nickname, std::shared_ptr<Session> session) {
-    std::lock_guard<std::mutex> lock(nickname_mutex_);
-    auto it = nickname_index_.find(nickname);
-    if (it != nickname_index_.end()) {
-        // 본인이 “마지막으로 등록된 세션”일 때만 삭제!
-        if (!it->second.expired() && it->second.lock() == session) {
-            nickname_index_.erase(it);
+    auto& shard = nickname_shard(nickname);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(nickname);
+    if (it != shard.index.end()) {
+        // 본인이 “마지막으로 등록된 세션”이거나 이미 만료된 항목일 때만 삭제!
+        auto owner = it->second.lock();
+        if (!owner || owner == session) {
+            shard.index.erase(it);
         }
     }
-	cleanup_expired_nicknames();  // 만료된 닉네임 정리
 }
 
 std::shared_ptr<Session> SessionManager::find_session_by_nickname(const std::string& nickname) {
-    std::lock_guard<std::mutex> lock(nickname_mutex_);
-    auto it = nickname_index_.find(nickname);
-    if (it != nickname_index_.end()) {
-        return it->second.lock();
+    auto& shard = nickname_shard(nickname);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(nickname);
+    if (it != shard.index.end()) {
+        if (auto session = it->second.lock()) return session;
+        shard.index.erase(it);   // 만료 항목은 만난 김에 회수
     }
     return nullptr;
 }
 
-size_t SessionManager::get_total_session_count() {
-    size_t total = 0;
-    for (unsigned int i = 0; i < shard_count_; ++i) {
-        std::lock_guard<std::mutex> lock(session_mutexes_[i]);
-        total += session_buckets_[i].size();
-    }
-    return total;
-}
-
-void SessionManager::cleanup_expired_nicknames() {
-    std::lock_guard<std::mutex> lock(nickname_mutex_);
-    for (auto it = nickname_index_.begin(); it != nickname_index_.end(); ) {
-        if (it->second.expired()) {
-            AppContext::instance().logger->info("[NICKNAME SWEEP] expired nickname entry removed: {}", it->first);
-            it = nickname_index_.erase(it);
-        }
-        else {
-            ++it;
-        }
-    }
-}
-
-void SessionManager::cleanup_inactive_sessions(std::chrono::seconds max_idle_time) {
-    auto now = std::chrono::steady_clock::now();
-
-    // (1) shard 락 안에서는 종료 대상만 수집
-    std::vector<std::shared_ptr<Session>> to_close;
-    to_close.reserve(64);
-
-    for (size_t shard = 0; shard < shard_count_; ++shard) {
-        std::lock_guard<std::mutex> lock(session_mutexes_[shard]);
-        for (auto& [id, sess] : session_buckets_[shard]) {
-            if (!sess) continue;
-            auto last_alive = sess->get_last_alive_time();
-            if (now - last_alive > max_idle_time) {
-                to_close.push_back(sess);
+size_t SessionManager::sweep_expired_nicknames(size_t max_shards) {
+    size_t removed = 0;
+    max_shards = std::min(max_shards, kNicknameShards);
+    size_t start = nickname_sweep_cursor_.fetch_add(max_shards, std::memory_order_relaxed);
+    for (size_t i = 0; i < max_shards; ++i) {
+        auto& shard = nickname_shards_[(start + i) % kNicknameShards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.index.begin(); it != shard.index.end(); ) {
+            if (it->second.expired()) {
+                it = shard.index.erase(it);
+                ++removed;
+            }
+            else {
+                ++it;
             }
         }
     }
-
-    // (2) 락을 모두 푼 뒤 실제 종료(내부에서 remove_session 재진입해도 안전)
-    for (auto& sess : to_close) {
-        if (!sess) continue;
-        AppContext::instance().logger->info(
-            "[SessionManager] 세션 {} 비활성 시간 초과, 종료 처리", sess->get_session_id());
-        sess->close_session();
-    }
+    return removed;
 }
-
-//void SessionManager::cleanup_inactive_sessions(std::chrono::seconds max_idle_time) {
-//    auto now = std::chrono::steady_clock::now();
-//    for (size_t shard = 0; shard < shard_count_; ++shard) {
-//        std::lock_guard<std::mutex> lock(session_mutexes_[shard]);
-//        for (auto it = session_buckets_[shard].begin(); it != session_buckets_[shard].end(); ) {
-//            auto& session = it->second;
-//            if (session) {
-//                auto last_alive = session->get_last_alive_time();
-//                if (now - last_alive > max_idle_time) {
-//                    AppContext::instance().logger->info("[SessionManager] 세션 {} 비활성 시간 초과, 종료 처리", session->get_session_id());
-//                    session->close_session();
-//                    it = session_buckets_[shard].erase(it);
-//                    continue;
-//                }
-//            }
-//            ++it;
-//        }
-//    }
-//}
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <memory>
 #include <mutex>
 #include <vector>
+#include <atomic>
+#include <utility>
 #include <functional>
 #include <string>
 #include "Session.h"
@@ -10,9 +12,22 @@
 
 class Session; // 전방 선언
 
+// 세션 레지스트리: 읽기 위주 구조
+// - shard 마다 불변 스냅샷(session_id 로 정렬된 vector)을 atomic 포인터로 발행 (copy-on-write, epoch 기반 회수)
+// - 조회/순회: epoch::Guard 안에서 스냅샷 포인터 load 1번 (shard 락 없음, 참조 카운트 증감 없음)
+// - add/remove: shard 쓰기 락 안에서 그 shard 만 복사해 교체. 복사되는 것은 (id, 항목 포인터) 뿐이고
+//   세션 shared_ptr 은 추가 때 만든 항목 1개가 끝까지 소유 → 이전 스냅샷/제거된 항목은 epoch::retire
+// - 세션 수는 atomic 으로 유지 (모니터링이 add/remove 를 막지 않음)
 class SessionManager {
 public:
+    using SessionEntry = std::pair<int, const std::shared_ptr<Session>*>;   // 항목은 세션이 레지스트리에 있는 동안 고정
+    using SessionSnapshot = std::vector<SessionEntry>;   // session_id 오름차순
+
     SessionManager(size_t shard_count);
+    ~SessionManager();
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
 
     // 세션 추가/삭제
     void add_session(std::shared_ptr<Session> session);
@@ -22,29 +37,54 @@ public:
     std::shared_ptr<Session> find_session(int session_id);
     std::shared_ptr<Session> find_session_by_nickname(const std::string& nickname);
 
-    // 전체 세션에 대해 함수 적용
+    // 전체 세션에 대해 함수 적용 (호출 시점 스냅샷 기준, fn 안에서 add/remove 해도 안전)
     void for_each_session(const std::function<void(const std::shared_ptr<Session>&)>& fn);
 
-    // 전체 세션 수
-    size_t session_count();
+    // 전체 세션 수 (atomic)
+    size_t session_count() const { return session_count_.load(std::memory_order_relaxed); }
 
-    // 닉네임 등록/해제
+    // 닉네임 등록/해제 (닉네임 해시로 고른 shard 하나만 잠금, O(1))
     void register_nickname(const std::string& nickname, std::shared_ptr<Session> session);
     void unregister_nickname(const std::string& nickname, std::shared_ptr<Session> session);
 
-    size_t get_total_session_count();
+    size_t get_total_session_count() const { return session_count(); }
 
-    void cleanup_expired_nicknames();
-
-    void cleanup_inactive_sessions(std::chrono::seconds max_idle_time);
+    // 만료된(세션이 사라진) 닉네임 항목 회수: 이어서 max_shards 개 shard 만 훑음 (모니터 루프에서 호출)
+    // 조회 시 만난 만료 항목은 그 자리에서 지우므로 이건 아무도 다시 찾지 않는 항목용
+    size_t sweep_expired_nicknames(size_t max_shards);
 
 private:
+    static constexpr size_t kMinShards = 64;   // add/remove 시 복사 크기 = 세션 수 / shard 수
+
+    struct alignas(64) Shard {
+        std::atomic<const SessionSnapshot*> snapshot{ nullptr };   // 읽기는 epoch::Guard 안에서만
+        std::mutex write_mutex;   // 쓰기끼리만 직렬화
+    };
+
+    // epoch 회수가 reader 의 slot 기록 → 포인터 읽기 순서에 기대므로 seq_cst
+    const SessionSnapshot* load_snapshot(size_t shard) const {
+        return shards_[shard].snapshot.load();
+    }
+    void publish_snapshot(size_t shard, const SessionSnapshot* snapshot) {
+        shards_[shard].snapshot.store(snapshot);
+    }
+
     size_t shard_count_ = 0;
-    std::vector<std::unordered_map<int, std::shared_ptr<Session>>> session_buckets_;
-    std::vector<std::mutex> session_mutexes_;
+    std::vector<Shard> shards_;
+    std::atomic<size_t> session_count_{ 0 };
+
+    static constexpr size_t kNicknameShards = 64;
+
+    struct alignas(64) NicknameShard {
+        std::unordered_map<std::string, std::weak_ptr<Session>> index;
+        std::mutex mutex;
+    };
+    std::vector<NicknameShard> nickname_shards_;
+    std::atomic<size_t> nickname_sweep_cursor_{ 0 };
 
-    std::unordered_map<std::string, std::weak_ptr<Session>> nickname_index_;
-    std::mutex nickname_mutex_;
+    NicknameShard& nickname_shard(const std::string& nickname) {
+        return nickname_shards_[std::hash<std::string>{}(nickname) % kNicknameShards];
+    }
 
     int get_shard(int session_id) const { return session_id % shard_count_; }
 };
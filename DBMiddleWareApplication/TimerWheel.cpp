@@ -0,0 +1,168 @@
+﻿#include "TimerWheel.h"
+#include <algorithm>
+#include "AppContext.h"
+#include "Config.h"
+
+boost::asio::execution_context::id TimerWheel::id;
+
+TimerWheel::TimerWheel(boost::asio::execution_context& ctx)
+    : boost::asio::execution_context::service(ctx),
+    tick_timer_(static_cast<boost::asio::io_context&>(ctx)),
+    tick_(current_config()->timer_wheel_tick) {
+    for (auto& level : heads_) level.fill(kNil);
+    next_tick_time_ = clock::now() + tick_;
+    start_tick_timer();
+}
+
+void TimerWheel::shutdown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    tick_timer_.cancel();
+    for (auto& node : nodes_) node.fn = nullptr;   // 콜백이 잡고 있는 세션 참조 해제
+}
+
+TimerWheel::TimerId TimerWheel::schedule(clock::duration delay, Callback cb) {
+    // 올림: 최소 1 tick 뒤 (지금 slot 은 이미 처리 중일 수 있음)
+    uint64_t ticks = static_cast<uint64_t>((std::max(delay, clock::duration::zero()) + tick_ - clock::duration(1)) / tick_);
+    ticks = std::max<uint64_t>(1, ticks);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index = alloc_node();
+    Node& node = nodes_[index];
+    node.expiry = current_tick_ + ticks;
+    node.fn = std::move(cb);
+    node.active = true;
+    place(index);
+    ++active_count_;
+    return TimerId{ index, node.generation };
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (!id) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id.index >= nodes_.size()) return false;
+    Node& node = nodes_[id.index];
+    if (!node.active || node.generation != id.generation) return false;
+    unlink(id.index);
+    free_node(id.index);
+    --active_count_;
+    return true;
+}
+
+size_t TimerWheel::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_count_;
+}
+
+void TimerWheel::start_tick_timer() {
+    tick_timer_.expires_at(next_tick_time_);
+    tick_timer_.async_wait([this](const boost::system::error_code& ec) {
+        if (ec) return;
+        std::vector<Callback> due;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopped_) return;
+            advance_to(clock::now(), due);
+        }
+        // 콜백은 락 밖에서 (콜백 안에서 schedule/cancel 해도 됨)
+        for (auto& fn : due) {
+            try {
+                fn();
+            }
+            catch (const std::exception& e) {
+                AppContext::instance().logger->error("[TimerWheel] callback exception: {}", e.what());
+            }
+        }
+        start_tick_timer();
+        });
+}
+
+void TimerWheel::advance_to(clock::time_point now, std::vector<Callback>& due) {
+    // 밀린 tick 이 있으면 한 번에 따라잡음 (next_tick_time_ 은 고정 간격으로만 증가 → drift 없음)
+    while (next_tick_time_ <= now) {
+        next_tick_time_ += tick_;
+        ++current_tick_;
+
+        // 상위 단계 slot 경계를 지나면 그 slot 의 타이머를 아래 단계로 내림
+        for (int level = 1; level < kLevels; ++level) {
+            uint64_t mask = (uint64_t(1) << (kSlotBits * level)) - 1;
+            if ((current_tick_ & mask) != 0) break;
+            uint32_t slot = static_cast<uint32_t>((current_tick_ >> (kSlotBits * level)) & (kSlots - 1));
+            uint32_t index = heads_[level][slot];
+            heads_[level][slot] = kNil;
+            while (index != kNil) {
+                uint32_t next = nodes_[index].next;
+                place(index);
+                index = next;
+            }
+        }
+
+        // 0단계 현재 slot = 이번 tick 에 만료되는 타이머
+        uint32_t slot = static_cast<uint32_t>(current_tick_ & (kSlots - 1));
+        uint32_t index = heads_[0][slot];
+        heads_[0][slot] = kNil;
+        while (index != kNil) {
+            uint32_t next = nodes_[index].next;
+            if (nodes_[index].expiry <= current_tick_) {
+                due.push_back(std::move(nodes_[index].fn));
+                free_node(index);
+                --active_count_;
+            }
+            else {
+                place(index);   // 최대 범위를 넘어 잘렸던 타이머 → 다시 배치
+            }
+            index = next;
+        }
+    }
+}
+
+void TimerWheel::place(uint32_t index) {
+    Node& node = nodes_[index];
+    uint64_t delta = node.expiry > current_tick_ ? node.expiry - current_tick_ : 0;
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) ++level;
+
+    uint64_t target = node.expiry;
+    uint64_t max_delta = (uint64_t(1) << (kSlotBits * (level + 1))) - 1;
+    if (delta > max_delta) target = current_tick_ + max_delta;   // 최대 범위 밖: 최대치에 두고 도달 시 재배치
+    if (delta == 0) target = current_tick_ + 1;                  // 이미 지난 타이머: 다음 tick
+
+    uint32_t slot = static_cast<uint32_t>((target >> (kSlotBits * level)) & (kSlots - 1));
+    link(index, level, slot);
+}
+
+void TimerWheel::link(uint32_t index, int level, uint32_t slot) {
+    Node& node = nodes_[index];
+    node.level = static_cast<uint8_t>(level);
+    node.slot = static_cast<uint8_t>(slot);
+    node.prev = kNil;
+    node.next = heads_[level][slot];
+    if (node.next != kNil) nodes_[node.next].prev = index;
+    heads_[level][slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.prev != kNil) nodes_[node.prev].next = node.next;
+    else heads_[node.level][node.slot] = node.next;
+    if (node.next != kNil) nodes_[node.next].prev = node.prev;
+    node.prev = node.next = kNil;
+}
+
+uint32_t TimerWheel::alloc_node() {
+    if (!free_nodes_.empty()) {
+        uint32_t index = free_nodes_.back();
+        free_nodes_.pop_back();
+        return index;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TimerWheel::free_node(uint32_t index) {
+    Node& node = nodes_[index];
+    node.active = false;
+    node.fn = nullptr;
+    ++node.generation;   // 이전 TimerId 무효화
+    free_nodes_.push_back(index);
+}
@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <boost/asio.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// io_context 마다 1개씩 붙는 계층형 타이머 휠 (asio service)
+// - 세션 로그인 타임아웃 / idle 만료 등 "대부분 취소되거나 늦게 울려도 되는" 타이머용
+// - schedule / cancel O(1), tick(기본 100ms) 마다 현재 slot 만 처리
+// - 4단계 × 64 slot: 6.4초 / 6.8분 / 7.3시간 / 19일 (tick=100ms 기준), 그 이상은 최대치로 잘림
+// - 콜백은 휠의 io_context 스레드에서 호출 (세션 작업은 콜백 안에서 세션 strand 로 넘길 것)
+// - per_core 모드에서는 io_context 당 스레드 1개라 락 경합 없음
+class TimerWheel : public boost::asio::execution_context::service {
+public:
+    using Callback = std::function<void()>;
+    using clock = std::chrono::steady_clock;
+
+    // 타이머 핸들 (slot 재사용 대비 generation 포함, 이미 울렸거나 취소된 id 로 cancel 해도 안전)
+    struct TimerId {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+        explicit operator bool() const { return index != UINT32_MAX; }
+    };
+
+    static boost::asio::execution_context::id id;
+
+    // 등록된 context 는 io_context 여야 함 (tick 타이머를 같은 context 에서 돌림)
+    explicit TimerWheel(boost::asio::execution_context& ctx);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    TimerId schedule(clock::duration delay, Callback cb);
+    bool cancel(TimerId id);   // 취소됐으면 true (이미 울렸으면 false)
+
+    size_t size() const;
+    std::chrono::milliseconds tick() const { return tick_; }
+
+private:
+    static constexpr int kSlotBits = 6;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr int kLevels = 4;
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Node {
+        uint64_t expiry = 0;       // 만료 tick
+        Callback fn;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        uint32_t generation = 0;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool active = false;
+    };
+
+    void shutdown() override;
+
+    void start_tick_timer();
+    void advance_to(clock::time_point now, std::vector<Callback>& due);
+    void place(uint32_t index);
+    void link(uint32_t index, int level, uint32_t slot);
+    void unlink(uint32_t index);
+    uint32_t alloc_node();
+    void free_node(uint32_t index);
+
+    boost::asio::steady_timer tick_timer_;
+    std::chrono::milliseconds tick_;
+    clock::time_point next_tick_time_;
+
+    mutable std::mutex mutex_;                                   // shared 모드(여러 스레드가 같은 io_context)를 위해
+    uint64_t current_tick_ = 0;
+    std::array<std::array<uint32_t, kSlots>, kLevels> heads_;    // slot 별 연결 리스트 head
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_nodes_;
+    size_t active_count_ = 0;
+    bool stopped_ = false;
+};
+
+// 해당 io_context(또는 그 executor 의 context)의 타이머 휠
+inline TimerWheel& timer_wheel(boost::asio::execution_context& ctx) {
+    return boost::asio::use_service<TimerWheel>(ctx);
+}
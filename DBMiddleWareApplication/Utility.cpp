@@ -6,6 +6,7 @@
 #include <cstdlib>
 #include "AppContext.h"
 #include <fstream>
+#include "Config.h"
 
 void send_admin_alert(const std::string& message) {
     static const char* slack_webhook_url = "https://hooks.slack.com/services/XXX/YYY/ZZZ"; // 본인 슬랙 URL로 교체
@@ -49,10 +50,9 @@ void load_config(const std::string& filename) {
     std::ifstream in(filename);
 
     if (!in.is_open()) {
-        AppContext::instance().config = nlohmann::json::object(); // fallback
-        throw std::runtime_error("config 파일 오픈 실패: " + filename);
+        throw std::runtime_error("config 파일 오픈 실패: " + filename);   // 기본값 스냅샷 유지
     }
     else {
-        AppContext::instance().config = nlohmann::json::parse(in);
+        publish_config(Config::from_json(nlohmann::json::parse(in)));
     }
 }
\ No newline at end of file
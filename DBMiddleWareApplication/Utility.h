@@ -45,4 +45,14 @@ inline std::optional<nlohmann::json> try_parse_json(const std::string& msg) {
 
 std::string get_env_secret(const std::string& env_name);
 
+// 상수 시간 비교 (secret 검증용): 첫 불일치 위치와 상관없이 항상 전체 길이를 비교
+inline bool constant_time_equals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    unsigned char diff = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
+
 void load_config(const std::string& path = "config.json");
\ No newline at end of file
@@ -0,0 +1,150 @@
+﻿#include "WireFormat.h"
+#include <string>
+#include <vector>
+
+const char* wire_format_name(WireFormat format) {
+    switch (format) {
+    case WireFormat::Json: return "json";
+    case WireFormat::MsgPack: return "msgpack";
+    case WireFormat::Cbor: return "cbor";
+    }
+    return "unknown";
+}
+
+std::optional<WireFormat> parse_wire_format(std::string_view name) {
+    if (name == "json") return WireFormat::Json;
+    if (name == "msgpack") return WireFormat::MsgPack;
+    if (name == "cbor") return WireFormat::Cbor;
+    return std::nullopt;
+}
+
+nlohmann::json decode_message(WireFormat format, std::string_view payload) {
+    switch (format) {
+    case WireFormat::MsgPack:
+        return nlohmann::json::from_msgpack(payload.begin(), payload.end());
+    case WireFormat::Cbor:
+        return nlohmann::json::from_cbor(payload.begin(), payload.end());
+    case WireFormat::Json:
+    default:
+        return nlohmann::json::parse(payload);
+    }
+}
+
+OutboundRef encode_message(WireFormat format, const nlohmann::json& msg) {
+    switch (format) {
+    case WireFormat::MsgPack: {
+        std::vector<uint8_t> bytes = nlohmann::json::to_msgpack(msg);
+        return OutboundRef::make({ reinterpret_cast<const char*>(bytes.data()), bytes.size() });
+    }
+    case WireFormat::Cbor: {
+        std::vector<uint8_t> bytes = nlohmann::json::to_cbor(msg);
+        return OutboundRef::make({ reinterpret_cast<const char*>(bytes.data()), bytes.size() });
+    }
+    case WireFormat::Json:
+    default:
+        return OutboundRef::make(msg.dump() + "\n");
+    }
+}
+
+std::string encode_body(WireFormat format, const nlohmann::json& msg) {
+    std::string out;
+    switch (format) {
+    case WireFormat::MsgPack:
+        nlohmann::json::to_msgpack(msg, out);
+        break;
+    case WireFormat::Cbor:
+        nlohmann::json::to_cbor(msg, out);
+        break;
+    case WireFormat::Json:
+    default:
+        out = msg.dump();
+        out += '\n';
+        break;
+    }
+    return out;
+}
+
+namespace {
+    // 항목 n 개짜리 map 헤더 (nlohmann 인코더와 같은 규칙: 가장 짧은 형태)
+    void append_map_header(WireFormat format, std::string& out, uint64_t n) {
+        auto append_be = [&out](uint64_t v, int bytes) {
+            for (int i = bytes - 1; i >= 0; --i) out += static_cast<char>((v >> (i * 8)) & 0xFF);
+        };
+        if (format == WireFormat::MsgPack) {
+            if (n <= 15) out += static_cast<char>(0x80 | n);
+            else if (n <= 0xFFFF) { out += static_cast<char>(0xDE); append_be(n, 2); }
+            else { out += static_cast<char>(0xDF); append_be(n, 4); }
+        }
+        else {   // Cbor (major type 5)
+            if (n <= 23) out += static_cast<char>(0xA0 | n);
+            else if (n <= 0xFF) { out += static_cast<char>(0xB8); append_be(n, 1); }
+            else if (n <= 0xFFFF) { out += static_cast<char>(0xB9); append_be(n, 2); }
+            else { out += static_cast<char>(0xBA); append_be(n, 4); }
+        }
+    }
+
+    // 바이너리 map 헤더 → (항목 수, 헤더 길이). map 이 아니거나 잘렸으면 false
+    bool read_map_header(WireFormat format, std::string_view body, uint64_t& n, size_t& header_size) {
+        if (body.empty()) return false;
+        auto read_be = [&body](size_t offset, int bytes, uint64_t& v) {
+            if (body.size() < offset + bytes) return false;
+            v = 0;
+            for (int i = 0; i < bytes; ++i) v = (v << 8) | static_cast<uint8_t>(body[offset + i]);
+            return true;
+        };
+        uint8_t lead = static_cast<uint8_t>(body[0]);
+        if (format == WireFormat::MsgPack) {
+            if ((lead & 0xF0) == 0x80) { n = lead & 0x0F; header_size = 1; return true; }
+            if (lead == 0xDE) { header_size = 3; return read_be(1, 2, n); }
+            if (lead == 0xDF) { header_size = 5; return read_be(1, 4, n); }
+            return false;
+        }
+        if (lead >= 0xA0 && lead <= 0xB7) { n = lead - 0xA0; header_size = 1; return true; }
+        if (lead == 0xB8) { header_size = 2; return read_be(1, 1, n); }
+        if (lead == 0xB9) { header_size = 3; return read_be(1, 2, n); }
+        if (lead == 0xBA) { header_size = 5; return read_be(1, 4, n); }
+        return false;   // 길이 미정(0xBF) / 8바이트 길이는 서버 응답에 없음
+    }
+}
+
+OutboundRef encode_with_request_id(WireFormat format, std::string_view body, int64_t request_id) {
+    std::string out;
+    if (format == WireFormat::Json) {
+        // {"req_id":N, + 나머지 (빈 객체면 쉼표 없이)
+        if (body.size() < 2 || body.front() != '{') return OutboundRef::make(body);
+        out.reserve(body.size() + 32);
+        out += "{\"";
+        out += kRequestIdField;
+        out += "\":";
+        out += std::to_string(request_id);
+        if (body[1] != '}') out += ',';
+        out.append(body.substr(1));
+        return OutboundRef::make(out);
+    }
+
+    uint64_t n = 0;
+    size_t header_size = 0;
+    if (!read_map_header(format, body, n, header_size)) return OutboundRef::make(body);
+    // {"req_id":N} 1개짜리 map 을 인코딩해서 헤더(1바이트)만 떼고 key/value 를 앞에 붙임
+    std::string field = encode_body(format, nlohmann::json{ { std::string(kRequestIdField), request_id } });
+    out.reserve(body.size() + field.size() + 4);
+    append_map_header(format, out, n + 1);
+    out.append(field, 1, std::string::npos);
+    out.append(body.substr(header_size));
+    return OutboundRef::make(out);
+}
+
+WireFormatStats& wire_format_stats(WireFormat format) {
+    static std::array<WireFormatStats, kWireFormatCount> stats;
+    return stats[static_cast<size_t>(format)];
+}
+
+PreframedReply::PreframedReply(std::string_view json_text) {
+    // Json 은 원문 그대로(줄바꿈 포함), 바이너리 포맷은 같은 논리 메시지를 인코딩
+    nlohmann::json msg = nlohmann::json::parse(json_text);
+    refs_[static_cast<size_t>(WireFormat::Json)] = OutboundRef::preframed(json_text);
+    std::vector<uint8_t> msgpack = nlohmann::json::to_msgpack(msg);
+    refs_[static_cast<size_t>(WireFormat::MsgPack)] = OutboundRef::preframed({ reinterpret_cast<const char*>(msgpack.data()), msgpack.size() });
+    std::vector<uint8_t> cbor = nlohmann::json::to_cbor(msg);
+    refs_[static_cast<size_t>(WireFormat::Cbor)] = OutboundRef::preframed({ reinterpret_cast<const char*>(cbor.data()), cbor.size() });
+}
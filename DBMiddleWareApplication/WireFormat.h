@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <nlohmann/json.hpp>
+#include "OutboundBuffer.h"
+
+// 세션별 메시지 인코딩 (secret 뒤 payload + 서버 응답 모두 적용)
+// - 기본 Json, 첫 프레임 {"type":"hello","format":"msgpack"|"cbor"} 로 전환
+// - 핸들러는 포맷과 상관없이 같은 nlohmann::json 논리 메시지를 받음
+enum class WireFormat : uint8_t { Json = 0, MsgPack = 1, Cbor = 2 };
+
+constexpr size_t kWireFormatCount = 3;
+
+const char* wire_format_name(WireFormat format);
+std::optional<WireFormat> parse_wire_format(std::string_view name);
+
+// payload → json (포맷별 decoder, 실패 시 nlohmann 예외)
+nlohmann::json decode_message(WireFormat format, std::string_view payload);
+// json → 프리픽스 포함 송신 버퍼 (Json 은 기존처럼 끝에 "\n")
+OutboundRef encode_message(WireFormat format, const nlohmann::json& msg);
+// json → 프리픽스 없는 본문 (캐시처럼 여러 세션/스레드가 공유할 때, 보낼 때는 OutboundRef::make)
+std::string encode_body(WireFormat format, const nlohmann::json& msg);
+
+// 요청 id: 요청에 있으면 그 요청의 응답에 같은 값을 그대로 실어 보냄 (클라이언트가 응답 순서와 무관하게 짝지음)
+inline constexpr std::string_view kRequestIdField = "req_id";
+// 이미 인코딩된 최상위 객체 본문 맨 앞에 "req_id" 를 끼워 넣은 송신 버퍼 (상수 응답/캐시 본문용, DOM 없음)
+// 본문이 객체가 아니면 그대로
+OutboundRef encode_with_request_id(WireFormat format, std::string_view body, int64_t request_id);
+
+// 포맷별 송수신 통계 (모니터 루프에서 출력)
+struct WireFormatStats {
+    std::atomic<uint64_t> messages_in{ 0 };
+    std::atomic<uint64_t> bytes_in{ 0 };
+    std::atomic<uint64_t> parse_ns{ 0 };      // decode 누적 시간
+    std::atomic<uint64_t> dom_parses{ 0 };    // 전체 DOM 까지 만든 메시지 수 (나머지는 type 스캔만)
+    std::atomic<uint64_t> messages_out{ 0 };
+    std::atomic<uint64_t> bytes_out{ 0 };
+};
+WireFormatStats& wire_format_stats(WireFormat format);
+
+// 고정 응답을 포맷별로 미리 인코딩해 둔 묶음 (static 으로 두고 공유, 할당 0)
+class PreframedReply {
+public:
+    explicit PreframedReply(std::string_view json_text);
+
+    const OutboundRef& get(WireFormat format) const { return refs_[static_cast<size_t>(format)]; }
+
+private:
+    std::array<OutboundRef, kWireFormatCount> refs_;
+};
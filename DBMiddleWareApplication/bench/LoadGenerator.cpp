@@ -0,0 +1,373 @@
+﻿// 부하 생성기: 실제 프레이밍(4바이트 길이 + secret 핸드셰이크 + JSON)으로 서버에 접속해서
+// 처리량과 응답 지연(p50/p99/p999)을 측정
+//
+// 사용 예 (같은 Linux 머신의 서버 대상):
+//   MY_SERVER_SECRET=... ./bench_load --connections=200 --duration=30 --rate=50000 --insert-pct=50 --payload=128
+//
+// - rate=0        : closed loop (연결마다 pipeline 개씩 응답 받으면 바로 다음 요청)
+// - rate>0        : open loop (전체 초당 요청 수를 연결에 나눠 일정 간격으로 전송)
+// - insert-pct    : insert 비율, 나머지는 미등록 type(bench_ping) → 서버가 바로 error 응답 (DB 안 거치는 왕복)
+// 연결마다 secret 핸드셰이크 후 바로 요청 (닉네임 등록 없음)
+// → 서버는 login_timeout_seconds 가 지나면 세션을 닫으므로 그보다 긴 측정은 서버 config 의 login_timeout_seconds 를 늘려서 실행
+// 요청마다 연결별 req_id 를 붙이고 서버가 응답에 그대로 돌려준 값으로 송신 시각을 찾아 지연 계산
+// → insert 가 DB 워커에서 순서 없이 끝나도 (open loop / pipeline>1) 지연이 정확함
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Metrics.h"
+
+using boost::asio::ip::tcp;
+using clock_type = std::chrono::steady_clock;
+namespace buckets = metrics::buckets;
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    unsigned short port = 6789;
+    std::string secret;
+    size_t connections = 100;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    int duration_sec = 10;
+    double rate = 0;              // 전체 초당 요청 수 (0 = closed loop)
+    size_t pipeline = 1;          // closed loop 에서 연결당 동시 요청 수
+    int insert_pct = 0;
+    size_t payload = 64;          // insert 값 문자열 길이
+    std::string table = "bench";
+
+};
+
+void usage() {
+    std::cerr <<
+        "options: --host= --port= --secret= (기본: $MY_SERVER_SECRET) --connections= --threads=\n"
+        "         --duration=(초) --rate=(전체 req/s, 0=closed loop) --pipeline= --insert-pct=(0~100)\n"
+        "         --payload=(bytes) --table=\n";
+}
+
+bool parse_options(int argc, char** argv, Options& opt) {
+    if (const char* secret = std::getenv("MY_SERVER_SECRET")) opt.secret = secret;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            usage();
+            return false;
+        }
+        std::string key = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+        if (key == "host") opt.host = value;
+        else if (key == "port") opt.port = static_cast<unsigned short>(std::stoul(value));
+        else if (key == "secret") opt.secret = value;
+        else if (key == "connections") opt.connections = std::stoul(value);
+        else if (key == "threads") opt.threads = std::max<size_t>(1, std::stoul(value));
+        else if (key == "duration") opt.duration_sec = std::stoi(value);
+        else if (key == "rate") opt.rate = std::stod(value);
+        else if (key == "pipeline") opt.pipeline = std::max<size_t>(1, std::stoul(value));
+        else if (key == "insert-pct") opt.insert_pct = std::clamp(std::stoi(value), 0, 100);
+        else if (key == "payload") opt.payload = std::stoul(value);
+        else if (key == "table") opt.table = value;
+        else {
+            usage();
+            return false;
+        }
+    }
+    if (opt.secret.empty()) {
+        std::cerr << "secret 이 없습니다 (--secret= 또는 MY_SERVER_SECRET)\n";
+        return false;
+    }
+    return true;
+}
+
+struct Totals {
+    std::atomic<uint64_t> sent{ 0 };
+    std::atomic<uint64_t> received{ 0 };
+    std::atomic<uint64_t> errors{ 0 };
+    std::atomic<uint64_t> unmatched{ 0 };   // req_id 가 없거나 모르는 id 인 응답
+    std::atomic<size_t> connected{ 0 };
+};
+
+std::string frame(std::string_view payload) {
+    uint32_t len = static_cast<uint32_t>(payload.size());
+    std::string out(4, '\0');
+    out[0] = static_cast<char>((len >> 24) & 0xFF);
+    out[1] = static_cast<char>((len >> 16) & 0xFF);
+    out[2] = static_cast<char>((len >> 8) & 0xFF);
+    out[3] = static_cast<char>(len & 0xFF);
+    out.append(payload);
+    return out;
+}
+
+class Connection : public std::enable_shared_from_this<Connection> {
+public:
+    Connection(boost::asio::io_context& io, const Options& opt, Totals& totals, size_t index)
+        : opt_(opt), totals_(totals), strand_(boost::asio::make_strand(io)), socket_(strand_),
+        timer_(strand_), rng_(static_cast<uint32_t>(index * 7919 + 1)), value_(opt.payload, 'x') {
+    }
+
+    void start(const tcp::endpoint& endpoint) {
+        auto self = shared_from_this();
+        socket_.async_connect(endpoint, [this, self](boost::system::error_code ec) {
+            if (ec) {
+                totals_.errors.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            socket_.set_option(tcp::no_delay(true));
+            totals_.connected.fetch_add(1, std::memory_order_relaxed);
+            enqueue(frame(opt_.secret));   // 핸드셰이크: secret 만 (서버는 응답 없음)
+            read_header();
+            start_requests();
+            });
+    }
+
+    void stop() {
+        auto self = shared_from_this();
+        boost::asio::post(strand_, [this, self]() {
+            running_ = false;
+            timer_.cancel();
+            boost::system::error_code ignored;
+            socket_.close(ignored);
+            });
+    }
+
+    const std::array<uint64_t, buckets::kCount>& histogram() const { return histogram_; }
+
+private:
+    void start_requests() {
+        if (opt_.rate > 0) {
+            interval_ = std::chrono::duration_cast<clock_type::duration>(
+                std::chrono::duration<double>(static_cast<double>(opt_.connections) / opt_.rate));
+            next_send_ = clock_type::now();
+            schedule_open_loop();
+        }
+        else {
+            for (size_t i = 0; i < opt_.pipeline; ++i) send_request();
+        }
+    }
+
+    void schedule_open_loop() {
+        next_send_ += interval_;
+        timer_.expires_at(next_send_);
+        auto self = shared_from_this();
+        timer_.async_wait([this, self](boost::system::error_code ec) {
+            if (ec || !running_) return;
+            send_request();
+            schedule_open_loop();
+            });
+    }
+
+    void send_request() {
+        if (!running_) return;
+        uint64_t req_id = next_req_id_++;
+        std::string payload;
+        if (static_cast<int>(rng_() % 100) < opt_.insert_pct) {
+            payload.reserve(96 + opt_.table.size() + value_.size());
+            payload += R"({"type":"insert","req_id":)";
+            payload += std::to_string(req_id);
+            payload += R"(,"table":")";
+            payload += opt_.table;
+            payload += R"(","values":{"seq":)";
+            payload += std::to_string(seq_++);
+            payload += R"(,"payload":")";
+            payload += value_;
+            payload += "\"}}";
+        }
+        else {
+            payload = R"({"type":"bench_ping","req_id":)";
+            payload += std::to_string(req_id);
+            payload += '}';
+        }
+        in_flight_.emplace(req_id, clock_type::now());
+        totals_.sent.fetch_add(1, std::memory_order_relaxed);
+        enqueue(frame(payload));
+    }
+
+    void enqueue(std::string data) {
+        outbox_.push_back(std::move(data));
+        if (outbox_.size() == 1) write_next();
+    }
+
+    void write_next() {
+        auto self = shared_from_this();
+        boost::asio::async_write(socket_, boost::asio::buffer(outbox_.front()),
+            [this, self](boost::system::error_code ec, std::size_t) {
+                if (ec) {
+                    if (running_) totals_.errors.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                outbox_.pop_front();
+                if (!outbox_.empty()) write_next();
+            });
+    }
+
+    void read_header() {
+        auto self = shared_from_this();
+        boost::asio::async_read(socket_, boost::asio::buffer(header_),
+            [this, self](boost::system::error_code ec, std::size_t) {
+                if (ec) {
+                    if (running_) totals_.errors.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                uint32_t len = (uint32_t(uint8_t(header_[0])) << 24) | (uint32_t(uint8_t(header_[1])) << 16) |
+                    (uint32_t(uint8_t(header_[2])) << 8) | uint32_t(uint8_t(header_[3]));
+                body_.resize(len);
+                read_body();
+            });
+    }
+
+    void read_body() {
+        auto self = shared_from_this();
+        boost::asio::async_read(socket_, boost::asio::buffer(body_),
+            [this, self](boost::system::error_code ec, std::size_t) {
+                if (ec) {
+                    if (running_) totals_.errors.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                on_reply();
+                read_header();
+            });
+    }
+
+    void on_reply() {
+        totals_.received.fetch_add(1, std::memory_order_relaxed);
+        auto it = in_flight_.end();
+        if (auto req_id = reply_request_id()) it = in_flight_.find(*req_id);
+        if (it == in_flight_.end()) {
+            totals_.unmatched.fetch_add(1, std::memory_order_relaxed);   // 요청 없이 온 알림 (notice 등)
+            return;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - it->second);
+        in_flight_.erase(it);
+        ++histogram_[buckets::index_of(static_cast<uint64_t>(elapsed.count()))];
+        if (opt_.rate <= 0) send_request();   // closed loop
+    }
+
+    // 응답 JSON 의 최상위 "req_id" 값 (bench 요청의 응답에만 있음, 문자열 안에 같은 글자가 나올 일은 없음)
+    std::optional<uint64_t> reply_request_id() const {
+        constexpr std::string_view key = R"("req_id")";
+        auto pos = body_.find(key);
+        if (pos == std::string::npos) return std::nullopt;
+        pos = body_.find_first_not_of(" \t\r\n:", pos + key.size());   // 서버는 공백 없이 보내지만 다른 구현도 허용
+        if (pos == std::string::npos) return std::nullopt;
+        const char* first = body_.data() + pos;
+        uint64_t value = 0;
+        auto [end, ec] = std::from_chars(first, body_.data() + body_.size(), value);
+        if (ec != std::errc()) return std::nullopt;
+        return value;
+    }
+
+    const Options& opt_;
+    Totals& totals_;
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    tcp::socket socket_;
+    boost::asio::steady_timer timer_;
+    std::mt19937 rng_;
+    std::string value_;
+    uint64_t seq_ = 0;
+    uint64_t next_req_id_ = 1;
+    bool running_ = true;
+
+    clock_type::duration interval_{};
+    clock_type::time_point next_send_{};
+
+    std::deque<std::string> outbox_;
+    std::unordered_map<uint64_t, clock_type::time_point> in_flight_;   // req_id → 송신 시각
+    std::array<char, 4> header_{};
+    std::string body_;
+    std::array<uint64_t, buckets::kCount> histogram_{};
+};
+
+double percentile_us(const std::array<uint64_t, buckets::kCount>& histogram, uint64_t total, double q) {
+    if (total == 0) return 0.0;
+    uint64_t target = static_cast<uint64_t>(q * static_cast<double>(total));
+    if (target == 0) target = 1;
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < buckets::kCount; ++i) {
+        cumulative += histogram[i];
+        if (cumulative >= target) return static_cast<double>(buckets::upper_of(i)) / 1000.0;
+    }
+    return static_cast<double>(buckets::upper_of(buckets::kCount - 1)) / 1000.0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) return 1;
+
+    boost::asio::io_context io(static_cast<int>(opt.threads));
+    auto work = boost::asio::make_work_guard(io);
+    tcp::resolver resolver(io);
+    tcp::endpoint endpoint = *resolver.resolve(opt.host, std::to_string(opt.port)).begin();
+
+    Totals totals;
+    std::vector<std::shared_ptr<Connection>> connections;
+    connections.reserve(opt.connections);
+    for (size_t i = 0; i < opt.connections; ++i) {
+        connections.push_back(std::make_shared<Connection>(io, opt, totals, i));
+        connections.back()->start(endpoint);
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < opt.threads; ++i) {
+        threads.emplace_back([&io]() { io.run(); });
+    }
+
+    std::printf("target=%s:%u connections=%zu threads=%zu mode=%s insert=%d%% payload=%zu\n",
+        opt.host.c_str(), opt.port, opt.connections, opt.threads,
+        opt.rate > 0 ? "open-loop" : "closed-loop", opt.insert_pct, opt.payload);
+
+    auto started = clock_type::now();
+    uint64_t last_received = 0;
+    for (int s = 0; s < opt.duration_sec; ++s) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        uint64_t received = totals.received.load(std::memory_order_relaxed);
+        std::printf("[%3ds] connected=%zu sent=%lu recv=%lu (%lu/s) errors=%lu\n", s + 1,
+            totals.connected.load(std::memory_order_relaxed),
+            static_cast<unsigned long>(totals.sent.load(std::memory_order_relaxed)),
+            static_cast<unsigned long>(received), static_cast<unsigned long>(received - last_received),
+            static_cast<unsigned long>(totals.errors.load(std::memory_order_relaxed)));
+        last_received = received;
+    }
+    double elapsed = std::chrono::duration<double>(clock_type::now() - started).count();
+
+    for (auto& c : connections) c->stop();
+    work.reset();
+    for (auto& t : threads) t.join();
+
+    std::array<uint64_t, buckets::kCount> merged{};
+    uint64_t samples = 0;
+    for (auto& c : connections) {
+        for (size_t i = 0; i < buckets::kCount; ++i) {
+            merged[i] += c->histogram()[i];
+            samples += c->histogram()[i];
+        }
+    }
+
+    uint64_t received = totals.received.load();
+    std::printf("\n=== result ===\n");
+    std::printf("sent=%lu received=%lu errors=%lu elapsed=%.2fs\n",
+        static_cast<unsigned long>(totals.sent.load()), static_cast<unsigned long>(received),
+        static_cast<unsigned long>(totals.errors.load()), elapsed);
+    std::printf("throughput=%.0f replies/s\n", static_cast<double>(received) / elapsed);
+    if (uint64_t unmatched = totals.unmatched.load()) {
+        std::printf("unmatched replies=%lu (req_id 없음, 서버가 req_id 를 돌려주는지 확인)\n", static_cast<unsigned long>(unmatched));
+    }
+    std::printf("latency(us, bucket upper bound) p50=%.1f p99=%.1f p999=%.1f\n",
+        percentile_us(merged, samples, 0.50), percentile_us(merged, samples, 0.99), percentile_us(merged, samples, 0.999));
+    return 0;
+}
@@ -0,0 +1,333 @@
+﻿// 마이크로벤치마크: 서버 코드를 그대로 링크해서 핫패스 단위로 측정
+//   ./bench_micro [필터]   (이름에 필터 문자열이 들어간 항목만 실행)
+//
+// - extract_message  : 누적 버퍼에서 프레임 분리 (프레임 크기별 ns/frame, MB/s)
+// - type lookup      : MessageType perfect hash vs std::string 키 unordered_map
+// - parse            : 최상위 type 스캔(peek_type) vs 전체 DOM 파싱 MB/s
+// - read path        : 수신 재무장을 세션 task 큐로 감싸던 기존 방식 vs strand 위에서 바로 (loopback, messages/sec)
+// - dispatch         : MessageDispatcher::dispatch 전체 (loopback 소켓에 실제 응답 write 포함)
+// - session registry : SessionManager find / for_each / add+remove
+//
+// 반복 횟수는 각 항목이 수백 ms 정도 돌도록 고정. 결과는 같은 머신에서 변경 전후 비교용
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <spdlog/sinks/null_sink.h>
+#include "AppContext.h"
+#include "Config.h"
+#include "DataHandler.h"
+#include "IncomingMessage.h"
+#include "MessageBufferManager.h"
+#include "MessageType.h"
+#include "Session.h"
+#include "SessionManager.h"
+
+using boost::asio::ip::tcp;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+const char* g_filter = nullptr;
+volatile uint64_t g_sink = 0;   // 결과를 버리지 않게 (최적화로 루프가 사라지는 것 방지)
+
+inline void sink(uint64_t value) { g_sink = g_sink + value; }
+
+bool selected(const char* name) {
+    return g_filter == nullptr || std::strstr(name, g_filter) != nullptr;
+}
+
+// ops 번 실행에 걸린 시간 → op 당 ns (bytes 가 있으면 MB/s 도)
+void report(const char* name, size_t ops, clock_type::duration elapsed, size_t bytes = 0) {
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    if (bytes) {
+        std::printf("%-44s %10.1f ns/op %10.1f MB/s\n", name, ns / ops, static_cast<double>(bytes) / (ns / 1e9) / 1e6);
+    }
+    else {
+        std::printf("%-44s %10.1f ns/op\n", name, ns / ops);
+    }
+}
+
+template <typename Fn>
+void run(const char* name, size_t iterations, Fn&& fn, size_t bytes_per_op = 0) {
+    if (!selected(name)) return;
+    for (size_t i = 0; i < iterations / 10; ++i) fn(i);   // 워밍업
+    auto started = clock_type::now();
+    for (size_t i = 0; i < iterations; ++i) fn(i);
+    report(name, iterations, clock_type::now() - started, bytes_per_op * iterations);
+}
+
+std::string frame(std::string_view payload) {
+    uint32_t len = static_cast<uint32_t>(payload.size());
+    std::string out(4, '\0');
+    out[0] = static_cast<char>((len >> 24) & 0xFF);
+    out[1] = static_cast<char>((len >> 16) & 0xFF);
+    out[2] = static_cast<char>((len >> 8) & 0xFF);
+    out[3] = static_cast<char>(len & 0xFF);
+    out.append(payload);
+    return out;
+}
+
+std::string insert_payload(size_t value_size) {
+    return R"({"type":"insert","table":"bench","values":{"seq":12345,"name":"user_0001","payload":")" +
+        std::string(value_size, 'x') + "\"}}";
+}
+
+// ---- MessageBufferManager::extract_message ----
+void bench_extract(size_t payload_size) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "extract_message/%zuB", payload_size);
+    if (!selected(name)) return;
+
+    // 64KB 분량의 프레임을 한 번에 받았다고 보고 append → 전부 extract
+    std::string one = frame(std::string(payload_size, 'a'));
+    size_t per_chunk = std::max<size_t>(1, 65536 / one.size());
+    std::string chunk;
+    for (size_t i = 0; i < per_chunk; ++i) chunk += one;
+
+    MessageBufferManager buf;
+    size_t rounds = std::max<size_t>(100, 20000000 / chunk.size());
+    auto started = clock_type::now();
+    size_t frames = 0;
+    for (size_t r = 0; r < rounds; ++r) {
+        buf.append(chunk.data(), chunk.size());
+        while (auto msg = buf.extract_message()) {
+            sink(msg->size());
+            ++frames;
+        }
+    }
+    report(name, frames, clock_type::now() - started, one.size() * frames);
+}
+
+// ---- type lookup: perfect hash vs 문자열 키 map (기존 dispatch 방식) ----
+void bench_type_lookup() {
+    const std::vector<std::string> types{ "insert", "hello", "bench_ping", "insert", "select" };
+    run("type lookup/perfect hash", 20000000, [&](size_t i) {
+        sink(static_cast<uint64_t>(lookup_message_type(types[i % types.size()])));
+        });
+
+    std::unordered_map<std::string, int> map{ { "hello", 1 }, { "insert", 2 } };
+    run("type lookup/unordered_map<string>", 20000000, [&](size_t i) {
+        std::string key(types[i % types.size()]);   // json 에서 꺼낸 std::string 키 (기존 방식)
+        auto it = map.find(key);
+        sink(it == map.end() ? 0 : it->second);
+        });
+}
+
+// ---- parse: type 스캔 vs 전체 DOM ----
+void bench_parse(size_t value_size) {
+    std::string payload = insert_payload(value_size);
+    char name[64];
+    std::snprintf(name, sizeof(name), "parse/peek_type/%zuB", payload.size());
+    run(name, 2000000, [&](size_t) {
+        IncomingMessage msg(WireFormat::Json, payload);
+        sink(msg.peek_type()->size());
+        }, payload.size());
+
+    std::snprintf(name, sizeof(name), "parse/json::parse/%zuB", payload.size());
+    run(name, 200000, [&](size_t) {
+        auto j = nlohmann::json::parse(payload);
+        sink(j.size());
+        }, payload.size());
+}
+
+// ---- read path: task 큐 경유(기존 Session::post_task + run_next_task) vs strand 위 직접 재무장 ----
+// Session::do_read 와 같은 골격 (prepare → async_read_some → commit → extract) 만 떼어서 재무장 비용만 비교
+class ReadLoop : public std::enable_shared_from_this<ReadLoop> {
+public:
+    ReadLoop(tcp::socket socket, bool via_task_queue, size_t target_frames)
+        : socket_(std::move(socket)), strand_(boost::asio::make_strand(socket_.get_executor())),
+        via_task_queue_(via_task_queue), target_frames_(target_frames) {}
+
+    void start() { arm(); }
+    size_t frames() const { return frames_; }
+
+private:
+    void arm() {
+        if (!via_task_queue_) {
+            read_once();
+            return;
+        }
+        // 기존: strand 로 dispatch → std::function 큐에 넣고 비어 있으면 run_next_task, 콜백 끝에서 다시 run_next_task
+        auto self = shared_from_this();
+        boost::asio::dispatch(strand_, [self]() {
+            self->tasks_.push([self]() { self->read_once(); });
+            if (!self->task_running_) {
+                self->task_running_ = true;
+                self->run_next_task();
+            }
+            });
+    }
+
+    void run_next_task() {
+        if (tasks_.empty()) {
+            task_running_ = false;
+            return;
+        }
+        auto fn = std::move(tasks_.front());
+        tasks_.pop();
+        fn();
+    }
+
+    void read_once() {
+        auto self = shared_from_this();
+        auto space = buf_.prepare(4096);
+        socket_.async_read_some(boost::asio::buffer(space.data(), space.size()),
+            boost::asio::bind_executor(strand_, [self](const boost::system::error_code& ec, size_t length) {
+                if (!ec) {
+                    self->buf_.commit(length);
+                    while (auto msg = self->buf_.extract_message()) {
+                        sink(msg->size());
+                        ++self->frames_;
+                    }
+                    if (self->frames_ < self->target_frames_) self->arm();
+                }
+                if (self->via_task_queue_) self->run_next_task();
+                }));
+    }
+
+    tcp::socket socket_;
+    boost::asio::strand<tcp::socket::executor_type> strand_;
+    MessageBufferManager buf_;
+    std::queue<std::function<void()>> tasks_;
+    bool task_running_ = false;
+    bool via_task_queue_;
+    size_t target_frames_;
+    size_t frames_ = 0;
+};
+
+// 클라이언트 스레드가 작은 프레임을 write 1번에 1개씩 계속 보냄 → read 1번에 프레임이 적게 들어와 재무장 비용이 드러남
+void bench_read_path(bool via_task_queue) {
+    const char* name = via_task_queue ? "read path/task queue (old)" : "read path/strand direct (new)";
+    if (!selected(name)) return;
+    boost::asio::io_context io;
+    tcp::acceptor acceptor(io, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    tcp::socket client(io);
+    client.connect(acceptor.local_endpoint());
+    tcp::socket server_side = acceptor.accept();
+    client.set_option(tcp::no_delay(true));
+
+    const size_t total = 2000000;
+    const std::string one = frame(R"({"type":"bench_ping"})");
+    std::thread writer([&client, &one, total]() {
+        boost::system::error_code ec;
+        for (size_t i = 0; i < total && !ec; ++i) boost::asio::write(client, boost::asio::buffer(one), ec);
+        });
+
+    auto loop = std::make_shared<ReadLoop>(std::move(server_side), via_task_queue, total);
+    auto started = clock_type::now();
+    loop->start();
+    io.run();
+    auto elapsed = clock_type::now() - started;
+    writer.join();
+
+    double sec = std::chrono::duration<double>(elapsed).count();
+    report(name, loop->frames(), elapsed, one.size() * loop->frames());
+    std::printf("%-44s %10.0f msg/s\n", "", static_cast<double>(loop->frames()) / sec);
+}
+
+// ---- MessageDispatcher::dispatch (응답 write 까지) ----
+void bench_dispatch() {
+    if (!selected("dispatch/")) return;
+    boost::asio::io_context io;
+    tcp::acceptor acceptor(io, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    tcp::socket client(io);
+    client.connect(acceptor.local_endpoint());
+    tcp::socket server_side = acceptor.accept();
+
+    // 응답은 별도 스레드가 계속 읽어서 버림 (소켓 버퍼가 차서 write 가 막히지 않게)
+    std::thread drain([&client]() {
+        std::vector<char> buf(65536);
+        boost::system::error_code ec;
+        while (!ec) client.read_some(boost::asio::buffer(buf), ec);
+        });
+
+    auto session_manager = std::make_shared<SessionManager>(64);
+    auto data_handler = std::make_shared<DataHandler>(io, session_manager, "bench-secret");
+    auto session = std::make_shared<Session>(std::move(server_side), 1, data_handler);
+    session_manager->add_session(session);
+    session->set_state(SessionState::Handshaked);   // secret 검사는 첫 프레임에서만 → 이후 프레임 기준으로 측정
+
+    auto dispatch_case = [&](const char* name, const std::string& payload) {
+        run(name, 1000000, [&](size_t i) {
+            data_handler->dispatch(session, payload);
+            if ((i & 31) == 31) io.poll();   // strand 에 쌓인 응답 write 처리
+            });
+        io.poll();
+    };
+    dispatch_case("dispatch/unknown type (error reply)", R"({"type":"bench_ping"})");
+    dispatch_case("dispatch/insert (no DB, full parse)", insert_payload(64));
+
+    boost::system::error_code ignored;
+    client.shutdown(tcp::socket::shutdown_both, ignored);
+    drain.join();
+    session->close_session();
+    io.poll();
+}
+
+// ---- SessionManager ----
+void bench_session_registry(size_t count) {
+    if (!selected("session registry/")) return;
+    boost::asio::io_context io;
+    SessionManager manager(64);
+    std::vector<std::shared_ptr<Session>> sessions;
+    sessions.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        sessions.push_back(std::make_shared<Session>(tcp::socket(io), static_cast<int>(i), std::weak_ptr<DataHandler>()));
+        manager.add_session(sessions.back());
+    }
+
+    std::mt19937 rng(42);
+    std::vector<int> ids(1 << 16);
+    for (auto& id : ids) id = static_cast<int>(rng() % count);
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "session registry/find (%zu sessions)", count);
+    run(name, 5000000, [&](size_t i) {
+        sink(manager.find_session(ids[i & (ids.size() - 1)]) ? 1 : 0);
+        });
+
+    std::snprintf(name, sizeof(name), "session registry/for_each (%zu sessions)", count);
+    run(name, 200, [&](size_t) {
+        manager.for_each_session([](const std::shared_ptr<Session>& s) { sink(s->get_session_id()); });
+        });
+
+    std::snprintf(name, sizeof(name), "session registry/remove+add (%zu sessions)", count);
+    run(name, 200000, [&](size_t i) {
+        auto& s = sessions[ids[i & (ids.size() - 1)]];
+        manager.remove_session(s->get_session_id());
+        manager.add_session(s);
+        });
+
+    std::snprintf(name, sizeof(name), "session registry/count (%zu sessions)", count);
+    run(name, 20000000, [&](size_t) { sink(manager.get_total_session_count()); });
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) g_filter = argv[1];
+
+    AppContext::instance().logger = spdlog::null_logger_mt("bench");
+    Config config;
+    config.recv_buffer_initial = config.recv_buffer_min = 1024;   // 세션 수만큼 잡히는 수신 버퍼 최소화
+    publish_config(config);
+
+    for (size_t size : { 32, 256, 1024, 4000 }) bench_extract(size);
+    bench_type_lookup();
+    for (size_t size : { 16, 512, 3500 }) bench_parse(size);
+    bench_read_path(true);
+    bench_read_path(false);
+    bench_dispatch();
+    bench_session_registry(20000);
+    return static_cast<int>(g_sink & 0);
+}